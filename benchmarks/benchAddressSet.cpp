@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <netaddr/addressset.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Random IPv4 and IPv6 addresses half and half
+static auto makeKeys(std::size_t count, std::size_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Raw> v(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i % 2) {
+            v[i] = Raw((Address4)rng());
+        } else {
+            v[i].data.qwords[0] = rng();
+            v[i].data.qwords[1] = rng();
+        }
+    }
+
+    return v;
+}
+
+static void benchmarkHashRaw(benchmark::State& state) {
+    auto keys = makeKeys(1024, 1);
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& key : keys) {
+            auto hash = std::hash<Raw>()(key);
+            benchmark::DoNotOptimize(hash);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template <typename Set>
+static void benchmarkSetInsert(benchmark::State& state) {
+    auto keys = makeKeys(state.range(0), 1);
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        Set set;
+        for (const auto& key : keys) {
+            set.insert(key);
+        }
+        benchmark::DoNotOptimize(set);
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+// Half of the lookups hit
+template <typename Set>
+static void benchmarkSetLookup(benchmark::State& state) {
+    auto keys = makeKeys(state.range(0), 1);
+    auto misses = makeKeys(state.range(0), 2);
+
+    Set set;
+    for (const auto& key : keys) {
+        set.insert(key);
+    }
+
+    std::vector<Raw> lookups;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        lookups.push_back(i % 2 ? keys[i] : misses[i]);
+    }
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937(3));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (const auto& key : lookups) {
+            found += set.count(key);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * lookups.size());
+}
+
+// std::unordered_set interface for AddressSet
+class CountingAddressSet : public AddressSet {
+  public:
+    std::size_t count(const Raw& key) const noexcept { return contains(key); }
+};
+
+BENCHMARK(benchmarkHashRaw);
+BENCHMARK_TEMPLATE(benchmarkSetInsert, std::unordered_set<Raw>)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(benchmarkSetInsert, CountingAddressSet)
+    ->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(benchmarkSetLookup, std::unordered_set<Raw>)
+    ->Arg(1 << 16)
+    ->Arg(1 << 22)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(benchmarkSetLookup, CountingAddressSet)
+    ->Arg(1 << 16)
+    ->Arg(1 << 22)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,56 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <netaddr/aggregate.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Blocklist-like IPv4 prefixes: mostly hosts and /24 in a few hot /8, so that
+// they overlap and touch each other
+static auto makeSubnets(std::size_t count) {
+    std::mt19937 rng(count);
+    std::vector<Subnet> v;
+    v.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        struct in_addr addr;
+        addr.s_addr = htonl((10 + rng() % 4) << 24 | (rng() & 0xFFFFFF));
+
+        auto dice = rng() % 10;
+        auto prefix = dice < 6 ? 32 : (dice < 9 ? 24 : 25 + rng() % 7);
+
+        char buf[INET_ADDRSTRLEN + 4];
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        auto sz = strlen(buf);
+        snprintf(buf + sz, sizeof(buf) - sz, "/%d", (int)prefix);
+
+        v.emplace_back(buf);
+    }
+
+    return v;
+}
+
+static void benchmarkAggregate(benchmark::State& state) {
+    auto subnets = makeSubnets(state.range(0));
+    std::size_t aggregated = 0;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        perf.pause();
+        auto v = subnets;
+        perf.resume();
+
+        aggregate(v);
+        aggregated = v.size();
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * subnets.size());
+    state.counters["aggregated"] = (double)aggregated;
+}
+
+BENCHMARK(benchmarkAggregate)->Arg(1000000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <netaddr/binary.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+static constexpr std::size_t Count = 1 << 20;
+
+// Prefix list files with the same random subnets, 80% of them IPv4
+static const std::string& makeFiles() {
+    static const std::string base = [] {
+        auto base = (std::filesystem::temp_directory_path() / "netaddr.bench").string();
+
+        std::mt19937_64 rng(Count);
+        std::vector<Subnet> subnets;
+        subnets.reserve(Count);
+        char text[Formatter::BufferSize];
+
+        for (std::size_t i = 0; i < Count; ++i) {
+            auto bits = rng();
+            if (bits % 5) {
+                auto length = Formatter::format4((Address4)bits, text) - text;
+                snprintf(text + length, sizeof(text) - length, "/%u",
+                         (unsigned)(8 + (bits >> 32) % 25));
+            } else {
+                Raw raw;
+                raw.data.qwords[0] = bits;
+                raw.data.qwords[1] = rng();
+                auto length = Formatter::format6(raw, text) - text;
+                snprintf(text + length, sizeof(text) - length, "/%u",
+                         (unsigned)(16 + (bits >> 32) % 113));
+            }
+            subnets.emplace_back(text);
+        }
+
+        std::ofstream file(base + ".txt", std::ios::trunc);
+        for (const auto& subnet : subnets) {
+            file << subnet.str() << '\n';
+        }
+
+        BinaryFormat::write(base + ".bin", subnets.data(), subnets.size());
+
+        return base;
+    }();
+
+    return base;
+}
+
+static void benchmarkLoadText(benchmark::State& state) {
+    auto path = makeFiles() + ".txt";
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::ifstream file(path);
+        std::vector<Subnet> subnets;
+        std::string line;
+
+        while (std::getline(file, line)) {
+            subnets.emplace_back(line);
+        }
+        benchmark::DoNotOptimize(subnets.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * Count);
+}
+
+// the argument is whether the checksum is verified
+static void benchmarkLoadBinary(benchmark::State& state) {
+    auto path = makeFiles() + ".bin";
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        MappedTable<CompactSubnet> table(path, state.range(0));
+        benchmark::DoNotOptimize(table.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * Count);
+}
+
+// Mapping and unpacking every entry into Subnet
+static void benchmarkLoadBinarySubnets(benchmark::State& state) {
+    auto path = makeFiles() + ".bin";
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        MappedTable<CompactSubnet> table(path, false);
+        std::vector<Subnet> subnets;
+        subnets.reserve(table.size());
+
+        for (const auto& entry : table) {
+            subnets.push_back(entry.subnet());
+        }
+        benchmark::DoNotOptimize(subnets.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * Count);
+}
+
+BENCHMARK(benchmarkLoadText)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkLoadBinary)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkLoadBinarySubnets)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <netaddr/addressset.h>
+#include <netaddr/bloom.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Share of lookups which hit, as in front of a blocklist
+static constexpr double HitShare = 0.001;
+
+static auto makeKeys(std::size_t count, std::size_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Raw> v(count);
+
+    for (auto& key : v) {
+        key.data.qwords[0] = rng();
+        key.data.qwords[1] = rng();
+    }
+
+    return v;
+}
+
+static auto makeLookups(const std::vector<Raw>& keys) {
+    constexpr std::size_t Count = 1 << 20;
+
+    auto lookups = makeKeys(Count, 2);
+    std::mt19937_64 rng(3);
+    for (std::size_t i = 0; i < (std::size_t)(Count * HitShare); ++i) {
+        lookups[rng() % Count] = keys[rng() % keys.size()];
+    }
+
+    return lookups;
+}
+
+// The first argument is the number of keys, the second one is the share of
+// false positives in 1/10000
+static auto makeFilter(benchmark::State& state, const std::vector<Raw>& keys) {
+    auto filter = std::make_unique<BloomFilter>(keys.size(), state.range(1) / 10000.0);
+    for (const auto& key : keys) {
+        filter->insert(key);
+    }
+
+    state.counters["bytes_per_key"] = (double)filter->bytes() / (double)keys.size();
+    return filter;
+}
+
+static void benchmarkBloomInsert(benchmark::State& state) {
+    auto keys = makeKeys(state.range(0), 1);
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        BloomFilter filter(keys.size(), state.range(1) / 10000.0);
+        for (const auto& key : keys) {
+            filter.insert(key);
+        }
+        benchmark::DoNotOptimize(filter);
+    }
+
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static void benchmarkBloomLookup(benchmark::State& state) {
+    auto keys = makeKeys(state.range(0), 1);
+    auto lookups = makeLookups(keys);
+    auto filter = makeFilter(state, keys);
+
+    std::size_t found = 0;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        found = 0;
+        for (const auto& key : lookups) {
+            found += filter->mayContain(key);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.counters["positives"] = (double)found / (double)lookups.size();
+    state.SetItemsProcessed(state.iterations() * lookups.size());
+}
+
+static void benchmarkBloomLookupBatch(benchmark::State& state) {
+    auto keys = makeKeys(state.range(0), 1);
+    auto lookups = makeLookups(keys);
+    auto filter = makeFilter(state, keys);
+    std::unique_ptr<bool[]> results(new bool[lookups.size()]);
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        filter->mayContain(lookups.data(), lookups.size(), results.get());
+        benchmark::DoNotOptimize(results.get());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * lookups.size());
+}
+
+// The exact set the filter stands in front of
+static void benchmarkBloomAddressSet(benchmark::State& state) {
+    auto keys = makeKeys(state.range(0), 1);
+    auto lookups = makeLookups(keys);
+
+    AddressSet set;
+    for (const auto& key : keys) {
+        set.insert(key);
+    }
+
+    // a key, a control byte and an empty value per slot
+    state.counters["bytes_per_key"] =
+        (double)(set.capacity() * (sizeof(Raw) + 2)) / (double)keys.size();
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (const auto& key : lookups) {
+            found += set.contains(key);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * lookups.size());
+}
+
+BENCHMARK(benchmarkBloomInsert)
+    ->ArgsProduct({{1 << 20}, {100}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkBloomLookup)
+    ->ArgsProduct({{1 << 16, 1 << 22}, {100, 10}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkBloomLookupBatch)
+    ->ArgsProduct({{1 << 16, 1 << 22}, {100, 10}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkBloomAddressSet)
+    ->Args({1 << 16, 0})
+    ->Args({1 << 22, 0})
+    ->Unit(benchmark::kMillisecond);
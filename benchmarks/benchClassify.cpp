@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <utility>
+#include <vector>
+
+#include <netaddr/classify.h>
+
+#include "dataset.h"
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+using Categories = Classifier::Categories;
+
+// Addresses of mixed traffic, the argument is the share of IPv4 in percents
+static const std::vector<Address>& makeAddresses(std::int64_t v4Share) {
+    static std::int64_t last = -1;
+    static std::vector<Address> addresses;
+
+    if (last != v4Share) {
+        Dataset data({Dataset::Family::MIXED, 1 << 14, 0, false, v4Share / 100.0});
+
+        addresses.clear();
+        for (auto item : data.items) {
+            addresses.emplace_back(item);
+        }
+        last = v4Share;
+    }
+
+    return addresses;
+}
+
+static std::vector<Raw> makeRaws(std::int64_t v4Share) {
+    std::vector<Raw> raws;
+    for (const auto& address : makeAddresses(v4Share)) {
+        raws.emplace_back(address.addr6());
+    }
+
+    return raws;
+}
+
+// The baseline: a Subnet::contains() call per range
+static void benchmarkClassifyContains(benchmark::State& state) {
+    static constexpr Categories Reachable = (Categories)1 << 31;
+    static constexpr auto Bogon = static_cast<Categories>(Classifier::Category::BOGON);
+
+    std::vector<std::pair<Subnet, Categories>> ranges;
+    for (const auto& range : Classifier::Ranges4) {
+        ranges.emplace_back(Subnet(range.subnet), range.categories);
+    }
+    for (const auto& range : Classifier::Ranges6) {
+        ranges.emplace_back(Subnet(range.subnet), range.categories);
+    }
+
+    auto& addresses = makeAddresses(state.range(0));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& address : addresses) {
+            Categories categories = 0;
+            for (const auto& [subnet, bits] : ranges) {
+                if (subnet.contains(address)) {
+                    categories |= bits;
+                }
+            }
+
+            if (categories & Reachable) {
+                categories &= ~(Reachable | Bogon);
+            }
+            benchmark::DoNotOptimize(categories);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+static void benchmarkClassify(benchmark::State& state) {
+    auto raws = makeRaws(state.range(0));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& raw : raws) {
+            auto categories = Classifier::classify(raw);
+            benchmark::DoNotOptimize(categories);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * raws.size());
+}
+
+static void benchmarkClassifyBatch(benchmark::State& state) {
+    auto raws = makeRaws(state.range(0));
+    std::vector<Categories> output(raws.size());
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        Classifier::classify(raws.data(), raws.size(), output.data());
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * raws.size());
+}
+
+BENCHMARK(benchmarkClassifyContains)->Arg(0)->Arg(70)->Arg(100);
+BENCHMARK(benchmarkClassify)->Arg(0)->Arg(70)->Arg(100);
+BENCHMARK(benchmarkClassifyBatch)->Arg(0)->Arg(70)->Arg(100);
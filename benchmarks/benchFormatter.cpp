@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <netaddr/formatter.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Random addresses where a third of pieces are zero, so that runs of zeros vary
+static auto makeAddresses6() {
+    std::mt19937 rng(6);
+    std::vector<Raw> v(4096);
+
+    for (auto& raw : v) {
+        for (auto& word : raw.data.words) {
+            word = (rng() % 3 == 0) ? 0 : (std::uint16_t)rng();
+        }
+    }
+
+    return v;
+}
+
+static auto makeAddresses4() {
+    std::mt19937 rng(4);
+    std::vector<Raw> v(4096);
+
+    for (auto& raw : v) {
+        raw = Raw((Address4)rng());
+    }
+
+    return v;
+}
+
+static void benchmarkToChars(benchmark::State& state, const std::vector<Raw>& data) {
+    char buf[Formatter::BufferSize];
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& raw : data) {
+            auto* end = toChars(raw, buf);
+            benchmark::DoNotOptimize(end);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void benchmarkInetNtop(benchmark::State& state, const std::vector<Raw>& data,
+                              int family) {
+    char buf[INET6_ADDRSTRLEN];
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& raw : data) {
+            auto* src = (family == AF_INET) ? (const void*)&raw.data.dwords[3]
+                                            : (const void*)&raw.data;
+            auto* rc = inet_ntop(family, src, buf, sizeof(buf));
+            benchmark::DoNotOptimize(rc);
+            benchmark::ClobberMemory();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void benchmarkToChars4(benchmark::State& state) {
+    benchmarkToChars(state, makeAddresses4());
+}
+
+static void benchmarkToChars6(benchmark::State& state) {
+    benchmarkToChars(state, makeAddresses6());
+}
+
+static void benchmarkInetNtop4(benchmark::State& state) {
+    benchmarkInetNtop(state, makeAddresses4(), AF_INET);
+}
+
+static void benchmarkInetNtop6(benchmark::State& state) {
+    benchmarkInetNtop(state, makeAddresses6(), AF_INET6);
+}
+
+static void benchmarkToCharsBatch(benchmark::State& state) {
+    auto data = makeAddresses6();
+    std::vector<char> buf(data.size() * Formatter::BufferSize);
+    std::size_t bytes = 0;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        auto* end = toChars(data.data(), data.size(), buf.data());
+        bytes += end - buf.data();
+        benchmark::DoNotOptimize(end);
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+    state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(benchmarkToChars4);
+BENCHMARK(benchmarkInetNtop4);
+BENCHMARK(benchmarkToChars6);
+BENCHMARK(benchmarkInetNtop6);
+BENCHMARK(benchmarkToCharsBatch);
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include <netaddr/loader.h>
+
+#include "dataset.h"
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+static constexpr std::size_t Lines = 4 << 20;
+
+// A prefix list of the realistic dataset
+static const std::string& makeFile() {
+    static const std::string path = [] {
+        auto path = std::filesystem::temp_directory_path() / "netaddr.loader.txt";
+
+        Dataset data({Dataset::Family::MIXED, Lines, 0, true});
+        std::ofstream(path, std::ios::trunc) << data.text;
+
+        return path.string();
+    }();
+
+    return path;
+}
+
+// the argument is the number of threads
+static void benchmarkLoadSubnets(benchmark::State& state) {
+    auto& path = makeFile();
+
+    PerfCounters perf(state, state.range(0) > 1);
+    for (auto _ : state) {
+        auto loaded = loadSubnets(path, state.range(0));
+        benchmark::DoNotOptimize(loaded.subnets.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * Lines);
+}
+
+BENCHMARK(benchmarkLoadSubnets)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Arg(16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <netaddr/lpm4.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Prefix lengths roughly follow the IPv4 DFZ: mostly /24, then /22, /23, /20
+static std::size_t randomLength(std::mt19937& rng) {
+    auto dice = rng() % 100;
+
+    if (dice < 60) {
+        return 24;
+    } else if (dice < 75) {
+        return 22;
+    } else if (dice < 85) {
+        return 23;
+    } else if (dice < 95) {
+        return 16 + rng() % 6;
+    } else if (dice < 98) {
+        return 8 + rng() % 8;
+    }
+
+    return 25 + rng() % 8;
+}
+
+static auto makeRoutes(std::size_t count) {
+    std::mt19937 rng(count);
+    std::vector<Lpm4<std::uint32_t>::Route> routes;
+    routes.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        struct in_addr addr;
+        addr.s_addr = rng();
+
+        char buf[INET_ADDRSTRLEN + 4];
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        auto sz = strlen(buf);
+        snprintf(buf + sz, sizeof(buf) - sz, "/%zu", randomLength(rng));
+
+        routes.emplace_back(Subnet(buf), (std::uint32_t)i);
+    }
+
+    return routes;
+}
+
+static auto makeAddresses(std::size_t count) {
+    std::mt19937 rng(count + 1);
+    std::vector<Address4> v(count);
+
+    for (auto& item : v) {
+        item = rng();
+    }
+
+    return v;
+}
+
+static void benchmarkLpm4Build(benchmark::State& state) {
+    auto routes = makeRoutes(state.range(0));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        Lpm4<std::uint32_t> lpm(routes);
+        benchmark::DoNotOptimize(lpm);
+    }
+
+    state.SetItemsProcessed(state.iterations() * routes.size());
+}
+
+static void benchmarkLpm4Lookup(benchmark::State& state) {
+    Lpm4<std::uint32_t> lpm(makeRoutes(state.range(0)));
+    auto addresses = makeAddresses(1 << 20);
+    std::vector<const std::uint32_t*> results(addresses.size());
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < addresses.size(); ++i) {
+            results[i] = lpm.lookup(addresses[i]);
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+static void benchmarkLpm4LookupBatch(benchmark::State& state) {
+    Lpm4<std::uint32_t> lpm(makeRoutes(state.range(0)));
+    auto addresses = makeAddresses(1 << 20);
+    std::vector<const std::uint32_t*> results(addresses.size());
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        lpm.lookup(addresses.data(), addresses.size(), results.data());
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+BENCHMARK(benchmarkLpm4Build)->Arg(100000)->Arg(900000)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkLpm4Lookup)->Arg(900000)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkLpm4LookupBatch)->Arg(900000)->Unit(benchmark::kMillisecond);
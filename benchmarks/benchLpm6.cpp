@@ -0,0 +1,177 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <netaddr/lpm6.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Prefix lengths roughly follow the IPv6 DFZ: mostly /48, then /32 and /29 to /47
+static std::size_t randomLength(std::mt19937& rng) {
+    auto dice = rng() % 100;
+
+    if (dice < 50) {
+        return 48;
+    } else if (dice < 65) {
+        return 32;
+    } else if (dice < 80) {
+        return 44;
+    } else if (dice < 95) {
+        return 29 + rng() % 19;
+    }
+
+    return 49 + rng() % 16;
+}
+
+// Random global unicast address, 2000::/3
+static struct in6_addr randomAddress(std::mt19937& rng) {
+    struct in6_addr addr;
+
+    for (auto& byte : addr.s6_addr) {
+        byte = (std::uint8_t)rng();
+    }
+    addr.s6_addr[0] = 0x20 | (addr.s6_addr[0] & 0x1F);
+
+    return addr;
+}
+
+static auto makeRoutes(std::size_t count) {
+    std::mt19937 rng(count);
+    std::vector<Lpm6<std::uint32_t>::Route> routes;
+    routes.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto addr = randomAddress(rng);
+
+        char buf[INET6_ADDRSTRLEN + 4];
+        inet_ntop(AF_INET6, &addr, buf, sizeof(buf));
+        auto sz = strlen(buf);
+        snprintf(buf + sz, sizeof(buf) - sz, "/%zu", randomLength(rng));
+
+        routes.emplace_back(Subnet(buf), (std::uint32_t)i);
+    }
+
+    return routes;
+}
+
+// Half of the addresses hit routes, the rest are random
+static auto makeAddresses(const std::vector<Lpm6<std::uint32_t>::Route>& routes,
+                          std::size_t count) {
+    std::mt19937 rng(count + 1);
+    std::vector<Raw> v(count);
+
+    for (auto& item : v) {
+        auto addr = randomAddress(rng);
+
+        if (rng() % 2) {
+            auto& subnet = routes[rng() % routes.size()].first;
+            auto network = subnet.addr6();
+            auto cidr = subnet.cidr();
+
+            for (std::size_t i = 0; i < sizeof(addr.s6_addr); ++i, cidr -= 8) {
+                if (cidr >= 8) {
+                    addr.s6_addr[i] = network.s6_addr[i];
+                    continue;
+                }
+                if (cidr > 0) {
+                    std::uint8_t mask = 0xFF << (8 - cidr);
+                    addr.s6_addr[i] =
+                        (network.s6_addr[i] & mask) | (addr.s6_addr[i] & ~mask);
+                }
+                break;
+            }
+        }
+
+        item = Raw(addr);
+    }
+
+    return v;
+}
+
+static void benchmarkLpm6Build(benchmark::State& state) {
+    auto routes = makeRoutes(state.range(0));
+    std::size_t memory = 0;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        Lpm6<std::uint32_t> lpm(routes);
+        memory = lpm.memory();
+        benchmark::DoNotOptimize(lpm);
+    }
+
+    state.SetItemsProcessed(state.iterations() * routes.size());
+    state.counters["memory"] = (double)memory;
+}
+
+static void benchmarkLpm6Lookup(benchmark::State& state) {
+    auto routes = makeRoutes(state.range(0));
+    Lpm6<std::uint32_t> lpm(routes);
+    auto addresses = makeAddresses(routes, 1 << 20);
+    std::vector<const std::uint32_t*> results(addresses.size());
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < addresses.size(); ++i) {
+            results[i] = lpm.lookup(addresses[i]);
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+// The baseline: the longest of all subnets containing an address
+static void benchmarkLpm6LinearScan(benchmark::State& state) {
+    auto routes = makeRoutes(state.range(0));
+    std::vector<Subnet> addresses;
+    for (auto& raw : makeAddresses(routes, 1024)) {
+        char buf[INET6_ADDRSTRLEN];
+        inet_ntop(AF_INET6, &raw.data, buf, sizeof(buf));
+        addresses.emplace_back(buf);
+    }
+    std::vector<const std::uint32_t*> results(addresses.size());
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < addresses.size(); ++i) {
+            const std::uint32_t* best = nullptr;
+            std::size_t len = 0;
+
+            for (const auto& route : routes) {
+                if (route.first.contains(addresses[i]) && route.first.cidr() >= len) {
+                    len = route.first.cidr();
+                    best = &route.second;
+                }
+            }
+            results[i] = best;
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+static void benchmarkLpm6LookupSmall(benchmark::State& state) {
+    auto routes = makeRoutes(state.range(0));
+    Lpm6<std::uint32_t> lpm(routes);
+    auto addresses = makeAddresses(routes, 1024);
+    std::vector<const std::uint32_t*> results(addresses.size());
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < addresses.size(); ++i) {
+            results[i] = lpm.lookup(addresses[i]);
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+BENCHMARK(benchmarkLpm6Build)->Arg(200000)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkLpm6Lookup)->Arg(200000)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkLpm6LinearScan)->Arg(1000);
+BENCHMARK(benchmarkLpm6LookupSmall)->Arg(1000);
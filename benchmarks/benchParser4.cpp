@@ -1,8 +1,13 @@
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 #include <netaddr/parser4.h>
 #include <netaddr/parser6.h>
 
+#include "dataset.h"
+#include "perfcounters.h"
+
 using namespace netaddr;
 
 // clang-format off
@@ -17,9 +22,21 @@ constexpr std::string_view BenchmarkData[] = {
     "0.0.0.0"
 };
 
+constexpr std::string_view BenchmarkDataCidr[] = {
+    "1.1.1.1/32",
+    "2.22.99.130/12",
+    "255.255.255.255/1",
+    "127.0.0.1/8",
+    "10.10.10.10/8",
+    "192.168.1.133/24",
+    "200.1.1.1/30",
+    "0.0.0.0/0"
+};
+
 // clang-format on
 
 static void benchmarkInetPton4(benchmark::State& state) {
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto item : BenchmarkData) {
             struct in_addr dst;
@@ -33,6 +50,7 @@ static void benchmarkInetPton4(benchmark::State& state) {
 static void benchmarkParse4(benchmark::State& state) {
     static constexpr Parser4 parser;
 
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto item : BenchmarkData) {
             Raw dst;
@@ -43,5 +61,151 @@ static void benchmarkParse4(benchmark::State& state) {
     }
 }
 
+static auto makeBatch(std::size_t count) {
+    std::vector<std::string_view> v;
+    v.reserve(count);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        v.push_back(BenchmarkData[i % std::size(BenchmarkData)]);
+    }
+
+    return v;
+}
+
+static void benchmarkParse4Loop(benchmark::State& state) {
+    static constexpr Parser4 parser;
+    auto input = makeBatch(state.range(0));
+    std::vector<Raw> output(input.size());
+    std::vector<std::uint64_t> bitmap((input.size() + 63) / 64);
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            bool ok = parser.parse(input[i], output[i]);
+            bitmap[i / 64] |= (std::uint64_t)ok << (i % 64);
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::DoNotOptimize(bitmap.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+// the second argument is the Cpu::Level of kernels
+static void benchmarkParse4Batch(benchmark::State& state) {
+    static constexpr Parser4 parser;
+    auto input = makeBatch(state.range(0));
+    std::vector<Raw> output(input.size());
+    std::vector<std::uint64_t> bitmap((input.size() + 63) / 64);
+
+    auto saved = Cpu::level();
+    auto level = static_cast<Cpu::Level>(state.range(1));
+    if (Cpu::setLevel(level) != level) {
+        state.SkipWithError("the CPU doesn't support the level");
+    }
+    state.SetLabel(Cpu::describe(level));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        auto total = parser.parseBatch(input.data(), input.size(), output.data(),
+                                       bitmap.data());
+        benchmark::DoNotOptimize(total);
+        benchmark::DoNotOptimize(output.data());
+    }
+
+    Cpu::setLevel(saved);
+    state.SetItemsProcessed(state.iterations() * input.size());
+}
+
+static void benchmarkParse4Cidr(benchmark::State& state) {
+    static constexpr Parser4 parser;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto item : BenchmarkDataCidr) {
+            Raw addr, mask;
+            std::size_t prefix = 0;
+
+            parser.parseCidr(item, addr, mask, prefix);
+            benchmark::DoNotOptimize(addr);
+            benchmark::DoNotOptimize(mask);
+            benchmark::DoNotOptimize(prefix);
+        }
+    }
+}
+
+// the way it was done before parseCidr(): split, parse the address and the prefix
+static void benchmarkParse4CidrSplit(benchmark::State& state) {
+    static constexpr Parser4 parser;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto item : BenchmarkDataCidr) {
+            Raw addr;
+            std::size_t prefix = 0;
+
+            auto it = item.find('/');
+            for (auto c : item.substr(it + 1)) {
+                prefix = prefix * 10 + (c - '0');
+            }
+            parser.parse(item.substr(0, it), addr);
+            benchmark::DoNotOptimize(addr);
+            benchmark::DoNotOptimize(prefix);
+        }
+    }
+}
+
+// Flow-log-like addresses from L1 to DRAM sized datasets, the second argument
+// is the percentage of malformed items
+static void benchmarkParse4Dataset(benchmark::State& state) {
+    static constexpr Parser4 parser;
+    auto& data = Dataset::get(
+        {Dataset::Family::IPV4, (std::size_t)state.range(0), state.range(1) / 100.0});
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : data.items) {
+            Raw dst;
+
+            valid += parser.parse(item, dst);
+            benchmark::DoNotOptimize(dst);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
+// The same addresses loaded straight from the buffer, 16 bytes at once
+static void benchmarkParse4DatasetPadded(benchmark::State& state) {
+    static constexpr Parser4 parser;
+    auto& data = Dataset::get(
+        {Dataset::Family::IPV4, (std::size_t)state.range(0), state.range(1) / 100.0});
+    auto& items = data.paddedItems();
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : items) {
+            Raw dst;
+
+            valid += parser.parse(item, dst);
+            benchmark::DoNotOptimize(dst);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
 BENCHMARK(benchmarkParse4);
 BENCHMARK(benchmarkInetPton4);
+BENCHMARK(benchmarkParse4Cidr);
+BENCHMARK(benchmarkParse4CidrSplit);
+BENCHMARK(benchmarkParse4Loop)->Arg(64)->Arg(4096);
+BENCHMARK(benchmarkParse4Batch)->ArgsProduct({{64, 4096}, {0, 1, 2, 3}});
+BENCHMARK(benchmarkParse4Dataset)->ArgsProduct({DatasetSizes, {0, 5}});
+BENCHMARK(benchmarkParse4DatasetPadded)->ArgsProduct({DatasetSizes, {0, 5}});
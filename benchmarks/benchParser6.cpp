@@ -1,8 +1,15 @@
 #include <benchmark/benchmark.h>
 
+#include <random>
+#include <string>
+#include <vector>
+
 #include <netaddr/parser4.h>
 #include <netaddr/parser6.h>
 
+#include "dataset.h"
+#include "perfcounters.h"
+
 using namespace netaddr;
 
 // clang-format off
@@ -16,9 +23,61 @@ constexpr std::string_view BenchmarkData[] = {
     "::"
 };
 
+// IPv4-mapped, NAT64 and IPv4-compatible addresses in the mixed notation as
+// inet_ntop() and logs print them
+constexpr std::string_view MixedData[] = {
+    "::ffff:192.168.1.1",
+    "::ffff:10.0.0.1",
+    "64:ff9b::203.0.113.7",
+    "::ffff:0:172.16.254.1",
+    "2001:db8::198.51.100.255",
+    "::1.2.3.4",
+    "::FFFF:8.8.8.8"
+};
+
+// the same addresses in hex
+constexpr std::string_view MixedHexData[] = {
+    "::ffff:c0a8:101",
+    "::ffff:a00:1",
+    "64:ff9b::cb00:7107",
+    "::ffff:0:ac10:fe01",
+    "2001:db8::c633:64ff",
+    "::102:304",
+    "::FFFF:808:808"
+};
+
 // clang-format on
 
+// canonical text of random addresses, so pieces and "::" vary from one item to
+// another as in real traffic
+static auto makeRandomData() {
+    constexpr std::size_t Count = 4096;
+
+    std::mt19937 rng(Count);
+    std::vector<std::string> v;
+    char buf[INET6_ADDRSTRLEN];
+
+    while (v.size() < Count) {
+        struct in6_addr addr;
+
+        for (std::size_t i = 0; i < sizeof(addr.s6_addr); i += 2) {
+            bool zero = (rng() % 3 == 0);
+            addr.s6_addr[i] = zero ? 0 : (std::uint8_t)rng();
+            addr.s6_addr[i + 1] = zero ? 0 : (std::uint8_t)rng();
+        }
+
+        inet_ntop(AF_INET6, &addr, buf, sizeof(buf));
+        // skip addresses which inet_ntop() prints with a dotted IPv4 suffix
+        if (std::string_view(buf).find('.') == std::string_view::npos) {
+            v.emplace_back(buf);
+        }
+    }
+
+    return v;
+}
+
 static void benchmarkInetPton6(benchmark::State& state) {
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto item : BenchmarkData) {
             struct in6_addr dst;
@@ -32,6 +91,7 @@ static void benchmarkInetPton6(benchmark::State& state) {
 static void benchmarkParse6(benchmark::State& state) {
     static constexpr Parser6 parser;
 
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto item : BenchmarkData) {
             Raw dst;
@@ -42,5 +102,124 @@ static void benchmarkParse6(benchmark::State& state) {
     }
 }
 
+static void benchmarkInetPton6Random(benchmark::State& state) {
+    auto data = makeRandomData();
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& item : data) {
+            struct in6_addr dst;
+
+            inet_pton(AF_INET6, item.data(), &dst);
+            benchmark::DoNotOptimize(dst);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void benchmarkParse6Random(benchmark::State& state) {
+    static constexpr Parser6 parser;
+    auto data = makeRandomData();
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& item : data) {
+            Raw dst;
+
+            parser.parse(item, dst);
+            benchmark::DoNotOptimize(dst);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+// Addresses of IPv6 traffic from L1 to DRAM sized datasets, the second argument
+// is the percentage of malformed items
+static void benchmarkParse6Dataset(benchmark::State& state) {
+    static constexpr Parser6 parser;
+    auto& data = Dataset::get(
+        {Dataset::Family::IPV6, (std::size_t)state.range(0), state.range(1) / 100.0});
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : data.items) {
+            Raw dst;
+
+            valid += parser.parse(item, dst);
+            benchmark::DoNotOptimize(dst);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
+// The same addresses loaded straight from the buffer
+static void benchmarkParse6DatasetPadded(benchmark::State& state) {
+    static constexpr Parser6 parser;
+    auto& data = Dataset::get(
+        {Dataset::Family::IPV6, (std::size_t)state.range(0), state.range(1) / 100.0});
+    auto& items = data.paddedItems();
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : items) {
+            Raw dst;
+
+            valid += parser.parse(item, dst);
+            benchmark::DoNotOptimize(dst);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
+template <const auto& Data>
+static void benchmarkInetPton6Mixed(benchmark::State& state) {
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto item : Data) {
+            struct in6_addr dst;
+
+            inet_pton(AF_INET6, item.data(), &dst);
+            benchmark::DoNotOptimize(dst);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * std::size(Data));
+}
+
+template <const auto& Data>
+static void benchmarkParse6Mixed(benchmark::State& state) {
+    static constexpr Parser6 parser;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto item : Data) {
+            Raw dst;
+
+            parser.parse(item, dst);
+            benchmark::DoNotOptimize(dst);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * std::size(Data));
+}
+
 BENCHMARK(benchmarkParse6);
 BENCHMARK(benchmarkInetPton6);
+BENCHMARK(benchmarkParse6Random);
+BENCHMARK(benchmarkInetPton6Random);
+BENCHMARK_TEMPLATE(benchmarkParse6Mixed, MixedData);
+BENCHMARK_TEMPLATE(benchmarkInetPton6Mixed, MixedData);
+BENCHMARK_TEMPLATE(benchmarkParse6Mixed, MixedHexData);
+BENCHMARK_TEMPLATE(benchmarkInetPton6Mixed, MixedHexData);
+BENCHMARK(benchmarkParse6Dataset)->ArgsProduct({DatasetSizes, {0, 5}});
+BENCHMARK(benchmarkParse6DatasetPadded)->ArgsProduct({DatasetSizes, {0, 5}});
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <regex>
+#include <string>
+
+#include <netaddr/scanner.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Access-log-like lines with an IPv4 client, an IPv6 upstream and noise
+static std::string makeLog(std::size_t size) {
+    std::mt19937 rng(size);
+    std::string text;
+    char line[256];
+
+    while (text.size() < size) {
+        auto length = snprintf(
+            line, sizeof(line),
+            "2024-05-01T12:%02u:%02u.%03uZ host=web-%02u src=10.%u.%u.%u:%u "
+            "dst=2a02:6b8::%x \"GET /api/v1/items/%u HTTP/1.1\" 200 %u %uus\n",
+            (unsigned)(rng() % 60), (unsigned)(rng() % 60), (unsigned)(rng() % 1000),
+            (unsigned)(rng() % 32), (unsigned)(rng() % 256), (unsigned)(rng() % 256),
+            (unsigned)(rng() % 256), (unsigned)(1024 + rng() % 60000),
+            (unsigned)(rng() % 0x10000), (unsigned)(rng() % 100000),
+            (unsigned)(rng() % 10000), (unsigned)(rng() % 100000));
+        text.append(line, length);
+    }
+
+    return text;
+}
+
+// the argument is the Cpu::Level of kernels
+static void benchmarkAddressScanner(benchmark::State& state) {
+    auto text = makeLog(16 << 20);
+    std::vector<AddressScanner::Match> matches;
+
+    auto saved = Cpu::level();
+    auto level = static_cast<Cpu::Level>(state.range(0));
+    if (Cpu::setLevel(level) != level) {
+        state.SkipWithError("the CPU doesn't support the level");
+    }
+    state.SetLabel(Cpu::describe(level));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        matches.clear();
+        auto total = AddressScanner::scan(text, matches);
+        benchmark::DoNotOptimize(total);
+    }
+
+    Cpu::setLevel(saved);
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// Candidates found by a regular expression and validated by the parsers
+static void benchmarkRegexScanner(benchmark::State& state) {
+    auto text = makeLog(1 << 20);
+    const std::regex pattern("[0-9A-Fa-f.:]+");
+    std::vector<Raw> matches;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        matches.clear();
+        for (std::cregex_iterator it(text.data(), text.data() + text.size(), pattern),
+             end;
+             it != end; ++it) {
+            std::string_view token(text.data() + it->position(), it->length());
+            Raw address;
+            if (Parser4::parse(token, address) || Parser6::parse(token, address)) {
+                matches.push_back(address);
+            }
+        }
+        benchmark::DoNotOptimize(matches.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(benchmarkAddressScanner)->Arg(0)->Arg(1)->Arg(2)->Arg(3);
+BENCHMARK(benchmarkRegexScanner);
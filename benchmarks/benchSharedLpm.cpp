@@ -0,0 +1,167 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <netaddr/sharedlpm.h>
+
+#include "dataset.h"
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+using Route = Lpm6<std::uint32_t>::Route;
+
+static constexpr std::size_t Routes = 100000;
+static constexpr std::size_t Addresses = 1 << 16;
+// routes the writer changes per update
+static constexpr std::size_t Batch = 100;
+
+static const std::vector<Route>& makeRoutes() {
+    static const auto routes = [] {
+        std::vector<Route> result;
+        auto& data = Dataset::get({Dataset::Family::MIXED, Routes, 0, true});
+        for (auto item : data.items) {
+            result.emplace_back(Subnet(item), (std::uint32_t)result.size());
+        }
+        return result;
+    }();
+
+    return routes;
+}
+
+static const std::vector<Raw>& makeAddresses() {
+    static const auto addresses = [] {
+        std::vector<Raw> result;
+        Dataset data({Dataset::Family::MIXED, Addresses, 0, false});
+        for (auto item : data.items) {
+            result.emplace_back(Subnet(item).addr6());
+        }
+        return result;
+    }();
+
+    return addresses;
+}
+
+// Changes `Batch` routes in a loop until destroyed, the first thread of a
+// benchmark owns it
+class Writer {
+  public:
+    Writer(bool enabled, std::function<void(std::size_t)> update) {
+        if (enabled) {
+            thread = std::thread([this, update]() mutable {
+                for (std::size_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                    update(i);
+                }
+            });
+        }
+    }
+
+    ~Writer() {
+        stop.store(true);
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+  private:
+    std::atomic<bool> stop{false};
+    std::thread thread;
+};
+
+static std::size_t batch(std::size_t round) {
+    return round * Batch % (Routes - Batch);
+}
+
+// Lookups of every thread, the argument is whether a writer updates routes
+static void benchmarkSharedLpmLookup(benchmark::State& state) {
+    static SharedLpm<std::uint32_t> table(makeRoutes());
+    auto& addresses = makeAddresses();
+    auto reader = table.reader();
+
+    std::unique_ptr<Writer> writer;
+    if (state.thread_index() == 0) {
+        writer = std::make_unique<Writer>(state.range(0), [](std::size_t round) {
+            auto first = makeRoutes().begin() + batch(round);
+            std::vector<Route> routes(first, first + Batch);
+            for (auto& route : routes) {
+                route.second = (std::uint32_t)round;
+            }
+
+            table.update(std::move(routes));
+        });
+    }
+
+    std::uint32_t value = 0;
+    std::size_t found = 0;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& address : addresses) {
+            found += reader.lookup(address, value);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+// The baseline: readers share a lock, the writer builds a table aside and
+// swaps it in under the exclusive lock
+static void benchmarkSharedMutexLookup(benchmark::State& state) {
+    static std::shared_mutex mutex;
+    static auto table = std::make_shared<Lpm6<std::uint32_t>>(makeRoutes());
+    static auto routes = makeRoutes();
+    auto& addresses = makeAddresses();
+
+    std::unique_ptr<Writer> writer;
+    if (state.thread_index() == 0) {
+        writer = std::make_unique<Writer>(state.range(0), [](std::size_t round) {
+            // only the writer changes routes
+            auto first = routes.begin() + batch(round);
+            for (auto it = first; it != first + Batch; ++it) {
+                it->second = (std::uint32_t)round;
+            }
+
+            auto fresh = std::make_shared<Lpm6<std::uint32_t>>(routes);
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            table.swap(fresh);
+        });
+    }
+
+    std::uint32_t value = 0;
+    std::size_t found = 0;
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& address : addresses) {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto* result = table->lookup(address);
+            if (result) {
+                value = *result;
+                ++found;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+        benchmark::DoNotOptimize(value);
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size());
+}
+
+BENCHMARK(benchmarkSharedLpmLookup)
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, 4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkSharedMutexLookup)
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, 4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
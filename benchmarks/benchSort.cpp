@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <netaddr/sort.h>
+
+#include "perfcounters.h"
+
+using namespace netaddr;
+
+// Flow-like addresses: IPv4 only or IPv6 only
+static auto makeRaws(std::size_t count, bool v6) {
+    std::mt19937_64 rng(count);
+    std::vector<Raw> v(count);
+
+    for (auto& raw : v) {
+        if (v6) {
+            raw.data.qwords[0] = rng();
+            raw.data.qwords[1] = rng();
+        } else {
+            raw = Raw((Address4)rng());
+        }
+    }
+
+    return v;
+}
+
+static void benchmarkStdSort(benchmark::State& state) {
+    auto data = makeRaws(state.range(0), state.range(1));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        perf.pause();
+        auto v = data;
+        perf.resume();
+
+        std::sort(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void benchmarkRadixSort(benchmark::State& state) {
+    auto data = makeRaws(state.range(0), state.range(1));
+
+    PerfCounters perf(state, state.range(2) > 1);
+    for (auto _ : state) {
+        perf.pause();
+        auto v = data;
+        perf.resume();
+
+        radixSort(v, state.range(2));
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static auto makeSubnets(std::size_t count) {
+    std::mt19937 rng(count);
+    std::vector<Subnet> v;
+    v.reserve(count);
+
+    for (auto& raw : makeRaws(count, false)) {
+        char buf[INET_ADDRSTRLEN + 4];
+        inet_ntop(AF_INET, &raw.data.dwords[3], buf, sizeof(buf));
+        auto sz = strlen(buf);
+        snprintf(buf + sz, sizeof(buf) - sz, "/%d", (int)(8 + rng() % 25));
+        v.emplace_back(buf);
+    }
+
+    return v;
+}
+
+static void benchmarkStdSortSubnet(benchmark::State& state) {
+    auto data = makeSubnets(state.range(0));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        perf.pause();
+        auto v = data;
+        perf.resume();
+
+        std::sort(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void benchmarkRadixSortSubnet(benchmark::State& state) {
+    auto data = makeSubnets(state.range(0));
+
+    PerfCounters perf(state, state.range(1) > 1);
+    for (auto _ : state) {
+        perf.pause();
+        auto v = data;
+        perf.resume();
+
+        radixSort(v, state.range(1));
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(benchmarkStdSort)
+    ->Args({1 << 22, 0})
+    ->Args({1 << 22, 1})
+    ->Unit(benchmark::kMillisecond);
+// the last argument is the number of threads
+BENCHMARK(benchmarkRadixSort)
+    ->Args({1 << 22, 0, 1})
+    ->Args({1 << 22, 0, 4})
+    ->Args({1 << 22, 1, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK(benchmarkStdSortSubnet)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmarkRadixSortSubnet)
+    ->Args({1 << 20, 1})
+    ->Args({1 << 20, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
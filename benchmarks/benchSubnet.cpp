@@ -1,8 +1,14 @@
 #include <benchmark/benchmark.h>
 
+#include <random>
 #include <vector>
 
-#include <netaddr/subnet.h>
+#include <netaddr/compactsubnet.h>
+#include <netaddr/subnet4.h>
+#include <netaddr/subnetset.h>
+
+#include "dataset.h"
+#include "perfcounters.h"
 
 using namespace netaddr;
 
@@ -28,6 +34,17 @@ constexpr std::string_view BenchmarkData6[] = {
     "::"
 };
 
+constexpr std::string_view BenchmarkDataInvalid[] = {
+    "a.b.c.d",
+    "999.255.255.255",
+    "10.10.10.10/33",
+    "10.10.10.10/",
+    "2001:db8:3333:44444:5555:6666:7777:8888",
+    "2001::db8::1",
+    "2001:db8::/129",
+    "Not even close"
+};
+
 // clang-format on
 
 static auto makeVector46() {
@@ -45,6 +62,7 @@ static auto makeVector46() {
 }
 
 static void benchmarkSubnet4(benchmark::State& state) {
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto item : BenchmarkData4) {
             auto subnet = Subnet(item);
@@ -54,6 +72,7 @@ static void benchmarkSubnet4(benchmark::State& state) {
 }
 
 static void benchmarkSubnet6(benchmark::State& state) {
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto item : BenchmarkData6) {
             auto subnet = Subnet(item);
@@ -62,9 +81,34 @@ static void benchmarkSubnet6(benchmark::State& state) {
     }
 }
 
+static void benchmarkSubnetInvalid(benchmark::State& state) {
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto item : BenchmarkDataInvalid) {
+            try {
+                auto subnet = Subnet(item);
+                benchmark::DoNotOptimize(subnet);
+            } catch (const std::invalid_argument& e) {
+                benchmark::DoNotOptimize(e);
+            }
+        }
+    }
+}
+
+static void benchmarkSubnetTryParseInvalid(benchmark::State& state) {
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto item : BenchmarkDataInvalid) {
+            auto result = Subnet::tryParse(item);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+}
+
 static void benchmarkSubnetContains(benchmark::State& state) {
     auto v = makeVector46();
 
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto it = v.begin(); it != v.end(); ++it) {
             for (auto it2 = it; it2 != v.end(); ++it2) {
@@ -75,9 +119,149 @@ static void benchmarkSubnetContains(benchmark::State& state) {
     }
 }
 
+static void benchmarkCompactSubnetContains(benchmark::State& state) {
+    std::vector<CompactSubnet> v;
+    for (const auto& subnet : makeVector46()) {
+        v.emplace_back(subnet);
+    }
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            for (auto it2 = it; it2 != v.end(); ++it2) {
+                auto rc = it2->contains(*it);
+                benchmark::DoNotOptimize(rc);
+            }
+        }
+    }
+}
+
+// Scans of a large table, which is where the memory footprint matters
+static auto makeTable(std::size_t count) {
+    std::mt19937 rng(count);
+    std::vector<Subnet> v;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        struct in6_addr addr;
+        for (auto& byte : addr.s6_addr) {
+            byte = (std::uint8_t)rng();
+        }
+
+        char buf[INET6_ADDRSTRLEN + 4];
+        inet_ntop(AF_INET6, &addr, buf, sizeof(buf));
+        auto sz = strlen(buf);
+        snprintf(buf + sz, sizeof(buf) - sz, "/%d", (int)(16 + rng() % 49));
+
+        v.emplace_back(buf);
+    }
+
+    return v;
+}
+
+template <typename T>
+static void benchmarkTableScan(benchmark::State& state) {
+    std::vector<T> table;
+    for (const auto& subnet : makeTable(state.range(0))) {
+        table.emplace_back(subnet);
+    }
+    T address(Subnet("2001:db8::1"));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (const auto& item : table) {
+            found += item.contains(address);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * table.size());
+    state.SetBytesProcessed(state.iterations() * table.size() * sizeof(T));
+}
+
+static void benchmarkSubnetSetContains(benchmark::State& state) {
+    auto v = makeVector46();
+    SubnetSet set(v);
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            auto rc = set.find(*it);
+            benchmark::DoNotOptimize(rc);
+        }
+    }
+}
+
+// An ACL of random IPv4 subnets, addresses mostly miss all of them, so that
+// every subnet is checked
+static auto makeAcl(std::size_t count) {
+    std::mt19937 rng(count);
+    std::vector<Subnet> acl, addresses;
+
+    auto random = [&rng]() {
+        struct in_addr addr;
+        addr.s_addr = rng();
+
+        char buf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        return std::string(buf);
+    };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        acl.emplace_back(random() + "/" + std::to_string(16 + rng() % 17));
+    }
+
+    for (std::size_t i = 0; i < 1024; ++i) {
+        addresses.emplace_back(random());
+    }
+
+    return std::make_pair(acl, addresses);
+}
+
+static void benchmarkAclContains(benchmark::State& state) {
+    auto [acl, addresses] = makeAcl(state.range(0));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& address : addresses) {
+            auto rc = std::find_if(acl.begin(), acl.end(), [&address](auto& subnet) {
+                return subnet.contains(address);
+            });
+            benchmark::DoNotOptimize(rc);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * addresses.size() * acl.size());
+}
+
+// the second argument is the Cpu::Level of kernels
+static void benchmarkAclSubnetSet(benchmark::State& state) {
+    auto [acl, addresses] = makeAcl(state.range(0));
+    SubnetSet set(acl);
+
+    auto saved = Cpu::level();
+    auto level = static_cast<Cpu::Level>(state.range(1));
+    if (Cpu::setLevel(level) != level) {
+        state.SkipWithError("the CPU doesn't support the level");
+    }
+    state.SetLabel(Cpu::describe(level));
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        for (const auto& address : addresses) {
+            auto rc = set.find(address);
+            benchmark::DoNotOptimize(rc);
+        }
+    }
+
+    Cpu::setLevel(saved);
+    state.SetItemsProcessed(state.iterations() * addresses.size() * acl.size());
+}
+
 static void benchmarkSubnetBelongs(benchmark::State& state) {
     auto v = makeVector46();
 
+    PerfCounters perf(state);
     for (auto _ : state) {
         for (auto it = v.begin(); it != v.end(); ++it) {
             for (auto it2 = it; it2 != v.end(); ++it2) {
@@ -88,7 +272,150 @@ static void benchmarkSubnetBelongs(benchmark::State& state) {
     }
 }
 
+// Prefix lists of 70% IPv4 and 30% IPv6 subnets from L1 to DRAM sized datasets,
+// the second argument is the percentage of malformed items
+static void benchmarkSubnetDataset(benchmark::State& state) {
+    auto& data = Dataset::get({Dataset::Family::MIXED, (std::size_t)state.range(0),
+                               state.range(1) / 100.0, true});
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : data.items) {
+            auto result = Subnet::tryParse(item);
+
+            valid += result.ok();
+            benchmark::DoNotOptimize(result);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
+// The same prefix lists loaded straight from the buffer
+static void benchmarkSubnetDatasetPadded(benchmark::State& state) {
+    auto& data = Dataset::get({Dataset::Family::MIXED, (std::size_t)state.range(0),
+                               state.range(1) / 100.0, true});
+    auto& items = data.paddedItems();
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : items) {
+            auto result = Subnet::tryParse(item);
+
+            valid += result.ok();
+            benchmark::DoNotOptimize(result);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
+// Subnets of a prefix list against addresses at random positions, which
+// miss the caches once the dataset outgrows them
+static void benchmarkSubnetContainsDataset(benchmark::State& state) {
+    auto count = (std::size_t)state.range(0);
+    auto& data = Dataset::get({Dataset::Family::MIXED, count, 0, true});
+
+    std::vector<Subnet> subnets;
+    subnets.reserve(count);
+    for (auto item : data.items) {
+        subnets.emplace_back(item);
+    }
+
+    std::mt19937_64 rng(count);
+    std::vector<std::uint32_t> pairs(count);
+    for (auto& pair : pairs) {
+        pair = (std::uint32_t)(rng() % count);
+    }
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            found += subnets[i].contains(subnets[pairs[i]]);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// IPv4 prefix lists parsed into Subnet or into the 8-byte Subnet4
+template <typename T>
+static void benchmarkSubnet4Dataset(benchmark::State& state) {
+    auto& data =
+        Dataset::get({Dataset::Family::IPV4, (std::size_t)state.range(0), 0, true});
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t valid = 0;
+        for (auto item : data.items) {
+            auto result = T::tryParse(item);
+
+            valid += result.ok();
+            benchmark::DoNotOptimize(result);
+        }
+        benchmark::DoNotOptimize(valid);
+    }
+
+    state.SetItemsProcessed(state.iterations() * data.items.size());
+    state.SetBytesProcessed(state.iterations() * data.bytes);
+}
+
+// IPv4 flow table lookups as in benchmarkSubnetContainsDataset, Subnet4 is six
+// times smaller than Subnet
+template <typename T>
+static void benchmarkContains4Dataset(benchmark::State& state) {
+    auto count = (std::size_t)state.range(0);
+    auto& data = Dataset::get({Dataset::Family::IPV4, count, 0, true});
+
+    std::vector<T> subnets;
+    subnets.reserve(count);
+    for (auto item : data.items) {
+        subnets.emplace_back(item);
+    }
+
+    std::mt19937_64 rng(count);
+    std::vector<std::uint32_t> pairs(count);
+    for (auto& pair : pairs) {
+        pair = (std::uint32_t)(rng() % count);
+    }
+
+    PerfCounters perf(state);
+    for (auto _ : state) {
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            found += subnets[i].contains(subnets[pairs[i]]);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+
 BENCHMARK(benchmarkSubnet4);
 BENCHMARK(benchmarkSubnet6);
+BENCHMARK(benchmarkSubnetInvalid);
+BENCHMARK(benchmarkSubnetTryParseInvalid);
 BENCHMARK(benchmarkSubnetContains);
+BENCHMARK(benchmarkCompactSubnetContains);
+BENCHMARK(benchmarkSubnetSetContains);
+BENCHMARK_TEMPLATE(benchmarkTableScan, Subnet)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(benchmarkTableScan, CompactSubnet)->Arg(1 << 22);
 BENCHMARK(benchmarkSubnetBelongs);
+BENCHMARK(benchmarkAclContains)->Arg(64)->Arg(512);
+BENCHMARK(benchmarkAclSubnetSet)->ArgsProduct({{64, 512}, {0, 1, 2, 3}});
+BENCHMARK(benchmarkSubnetDataset)->ArgsProduct({DatasetSizes, {0, 5}});
+BENCHMARK(benchmarkSubnetDatasetPadded)->ArgsProduct({DatasetSizes, {0, 5}});
+BENCHMARK(benchmarkSubnetContainsDataset)->ArgsProduct({DatasetSizes});
+BENCHMARK_TEMPLATE(benchmarkSubnet4Dataset, Subnet)->ArgsProduct({DatasetSizes});
+BENCHMARK_TEMPLATE(benchmarkSubnet4Dataset, Subnet4)->ArgsProduct({DatasetSizes});
+BENCHMARK_TEMPLATE(benchmarkContains4Dataset, Subnet)->ArgsProduct({DatasetSizes});
+BENCHMARK_TEMPLATE(benchmarkContains4Dataset, Subnet4)->ArgsProduct({DatasetSizes});
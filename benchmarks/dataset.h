@@ -0,0 +1,303 @@
+#pragma once
+#ifndef NETADDR_BENCHMARKS_DATASET_H_
+#define NETADDR_BENCHMARKS_DATASET_H_
+
+#include <memory>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <netaddr/address.h>
+
+namespace netaddr {
+
+// Deterministic corpora of address and subnet text shaped like production data,
+// large enough to leave the caches. Only the raw output of std::mt19937_64 is
+// used, so every standard library makes the same data.
+class Dataset {
+  public:
+    enum class Family : std::uint8_t {
+        IPV4,
+        IPV6,
+        MIXED,
+    };
+
+    struct Config {
+        Family family = Family::MIXED;
+        std::size_t count = 1 << 16;
+        // share of malformed items
+        double invalid = 0;
+        // subnets with BGP-like prefix lengths instead of addresses
+        bool prefixes = false;
+        // share of IPv4 items of MIXED datasets
+        double v4Share = 0.7;
+        std::uint64_t seed = 18;
+
+        bool operator==(const Config& other) const noexcept {
+            return std::tie(family, count, invalid, prefixes, v4Share, seed) ==
+                   std::tie(other.family, other.count, other.invalid, other.prefixes,
+                            other.v4Share, other.seed);
+        }
+    };
+
+    // items separated by '\n', a prefix list when `prefixes` is set
+    std::string text;
+    std::vector<std::string_view> items;
+    // length of all items without separators
+    std::size_t bytes = 0;
+
+    explicit Dataset(const Config& config) : rng(config.seed) {
+        std::vector<std::size_t> offsets;
+        offsets.reserve(config.count);
+
+        for (std::size_t i = 0; i < config.count; ++i) {
+            bool v4 = config.family == Family::IPV4 ||
+                      (config.family == Family::MIXED && chance(config.v4Share));
+
+            auto item = v4 ? make4(config.prefixes) : make6(config.prefixes);
+            if (chance(config.invalid)) {
+                item = corrupt(item, config.prefixes);
+            }
+
+            offsets.push_back(text.size());
+            text += item;
+            text += '\n';
+        }
+
+        items.reserve(offsets.size());
+        for (std::size_t i = 0; i < offsets.size(); ++i) {
+            auto end = (i + 1 < offsets.size()) ? offsets[i + 1] : text.size();
+            items.emplace_back(text.data() + offsets[i], end - offsets[i] - 1);
+            bytes += items.back().size();
+        }
+    }
+
+    // `items` in a copy of `text` followed by PaddedStringView::Padding zeros,
+    // made on first use
+    const std::vector<PaddedStringView>& paddedItems() const {
+        if (padded.size() != items.size()) {
+            buffer = text;
+            buffer.append(PaddedStringView::Padding, '\0');
+
+            padded.reserve(items.size());
+            for (auto item : items) {
+                padded.emplace_back(buffer.data() + (item.data() - text.data()),
+                                    item.size());
+            }
+        }
+
+        return padded;
+    }
+
+    // Google Benchmark runs a benchmark many times with the same arguments, so
+    // the last dataset is kept
+    static const Dataset& get(const Config& config) {
+        static Config last;
+        static std::unique_ptr<Dataset> cached;
+
+        if (!cached || !(last == config)) {
+            cached.reset();
+            cached = std::make_unique<Dataset>(config);
+            last = config;
+        }
+
+        return *cached;
+    }
+
+  private:
+    // popular /32 allocations of IPv6 providers
+    static constexpr std::uint32_t Providers6[] = {
+        0x20010db8, 0x2a0206b8, 0x2a001450, 0x26064700,
+        0x26001f18, 0x24048000, 0x2c0ffb50, 0x2a03b0c0,
+    };
+
+    std::uint64_t next() { return rng(); }
+
+    std::uint64_t below(std::uint64_t bound) { return rng() % bound; }
+
+    bool chance(double share) { return (double)(rng() >> 11) * 0x1.0p-53 < share; }
+
+    static std::string format4(std::uint32_t host, std::size_t prefix) {
+        char text[Formatter::BufferSize];
+        auto* end = Formatter::format4(htonl(host), text);
+        if (prefix != 32) {
+            end = Formatter::formatPrefix(prefix, end);
+        }
+
+        return {text, end};
+    }
+
+    // Private networks, public space and many small host numbers as in
+    // flow logs, /24-heavy prefix lengths as in BGP tables
+    std::string make4(bool prefixes) {
+        std::uint32_t host = (std::uint32_t)next();
+        auto kind = below(100);
+
+        if (kind < 15) {
+            host = 0x0A000000 | (host & 0x00FFFFFF);
+        } else if (kind < 25) {
+            host = 0xC0A80000 | (host & 0x0000FFFF);
+        } else if (kind < 30) {
+            host = 0xAC100000 | (host & 0x000FFFFF);
+        } else {
+            // 1-223, unicast
+            host = (std::uint32_t)(1 + below(223)) << 24 | (host & 0x00FFFFFF);
+        }
+
+        if (chance(0.5)) {
+            host = (host & ~0xFFU) | (std::uint32_t)(1 + below(20));
+        }
+
+        if (!prefixes) {
+            return format4(host, 32);
+        }
+
+        std::size_t prefix;
+        auto length = below(100);
+        if (length < 55) {
+            prefix = 24;
+        } else if (length < 75) {
+            prefix = 22 + below(2);
+        } else if (length < 92) {
+            prefix = 16 + below(6);
+        } else if (length < 95) {
+            prefix = 8 + below(8);
+        } else {
+            prefix = 32;
+        }
+
+        auto mask = prefix ? ~0U << (32 - prefix) : 0;
+        return format4(host & mask, prefix);
+    }
+
+    // Shapes of real IPv6 traffic: SLAAC addresses, servers with "::" in the
+    // middle, link-local, mapped, random zero runs and non-canonical text with
+    // leading zeros and capitals. Prefix lengths are mostly /48 and /32.
+    std::string make6(bool prefixes) {
+        Raw raw;
+        auto& words = raw.data.words;
+        std::size_t prefix = 128;
+        bool canonical = true;
+
+        auto provider = Providers6[below(std::size(Providers6))];
+        auto kind = below(100);
+
+        if (kind < 35) {
+            // provider, site, subnet and a random interface identifier
+            raw.data.dwords[0] = htonl(provider);
+            raw.data.dwords[1] = (std::uint32_t)next();
+            raw.data.qwords[1] = next();
+        } else if (kind < 60) {
+            raw.data.dwords[0] = htonl(provider);
+            words[2] = htons((std::uint16_t)below(16));
+            words[7] = htons((std::uint16_t)(1 + below(0xFF)));
+        } else if (kind < 70) {
+            words[0] = htons(0xFE80);
+            raw.data.qwords[1] = next();
+        } else if (kind < 85) {
+            for (auto& word : words) {
+                word = chance(1.0 / 3) ? 0 : (std::uint16_t)next();
+            }
+        } else if (kind < 92) {
+            words[5] = 0xFFFF;
+            raw.data.dwords[3] = (std::uint32_t)next();
+        } else if (kind < 95) {
+            words[7] = htons((std::uint16_t)below(2));
+        } else {
+            raw.data.dwords[0] = htonl(provider);
+            raw.data.qwords[1] = next();
+            canonical = false;
+        }
+
+        // link-local addresses are hosts
+        if (prefixes && kind < 85 && (kind < 60 || kind >= 70)) {
+            auto length = below(100);
+            if (length < 50) {
+                prefix = 48;
+            } else if (length < 65) {
+                prefix = 32;
+            } else if (length < 80) {
+                prefix = 40 + below(8);
+            } else if (length < 85) {
+                prefix = 29 + below(3);
+            } else if (length < 95) {
+                prefix = 64;
+            } else {
+                prefix = 56;
+            }
+            mask(raw, prefix);
+        }
+
+        char text[Formatter::BufferSize * 2];
+        char* end;
+        if (canonical) {
+            end = Formatter::format6(raw, text);
+        } else {
+            end = text;
+            for (std::size_t i = 0; i < std::size(words); ++i) {
+                end += snprintf(end, 6, i ? ":%04X" : "%04X", ntohs(words[i]));
+            }
+        }
+        if (prefix != 128) {
+            end = Formatter::formatPrefix(prefix, end);
+        }
+
+        return {text, end};
+    }
+
+    static void mask(Raw& raw, std::size_t prefix) {
+        for (std::size_t i = 0; i < SizeIPv6; ++i) {
+            auto bits = prefix > i * 8 ? prefix - i * 8 : 0;
+            raw.data.bytes[i] &= bits >= 8 ? 0xFF : (std::uint8_t)(0xFF00 >> bits);
+        }
+    }
+
+    // Typos, truncation, out of range octets and prefixes. Mutations are
+    // repeated until the item doesn't parse any more.
+    std::string corrupt(std::string item, bool prefixes) {
+        static constexpr char Garbage[] = "g.:-x/ Z";
+
+        auto valid = [prefixes](const std::string& text) {
+            return prefixes ? (bool)Subnet::tryParse(text)
+                            : (bool)Address::tryParse(text);
+        };
+
+        while (valid(item)) {
+            auto pos = below(item.size());
+            switch (below(5)) {
+            case 0:
+                item[pos] = Garbage[below(sizeof(Garbage) - 1)];
+                break;
+            case 1:
+                item.resize(pos);
+                break;
+            case 2:
+                item.insert(pos, 1, item.find(':') == item.npos ? '.' : ':');
+                break;
+            case 3:
+                item.insert(pos, "999");
+                break;
+            case 4:
+                item = item.substr(0, item.find('/')) +
+                       (item.find(':') == item.npos ? "/33" : "/129");
+                break;
+            }
+        }
+
+        return item;
+    }
+
+    std::mt19937_64 rng;
+
+    mutable std::string buffer;
+    mutable std::vector<PaddedStringView> padded;
+};
+
+// from a few KiB, which stay in L1, to hundreds of MiB
+inline const std::vector<std::int64_t> DatasetSizes = {1 << 8, 1 << 12, 1 << 16, 1 << 20,
+                                                       1 << 22};
+
+} // namespace netaddr
+
+#endif
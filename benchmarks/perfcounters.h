@@ -0,0 +1,198 @@
+#pragma once
+#ifndef NETADDR_BENCHMARKS_PERFCOUNTERS_H_
+#define NETADDR_BENCHMARKS_PERFCOUNTERS_H_
+
+#include <benchmark/benchmark.h>
+
+#if defined(NETADDR_PERF_COUNTERS) && defined(__linux__)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace netaddr {
+
+// Hardware counters of the benchmark loop, which is where the object lives,
+// reported as user counters per item, or per iteration if a benchmark doesn't
+// count items. Counters are collected with perf_event_open() when the target
+// is built with WITH_PERF_COUNTERS on Linux, they are silently missing if the
+// kernel doesn't allow them, see /proc/sys/kernel/perf_event_paranoid.
+//
+// Events count the thread which runs single-threaded benchmarks only, so
+// benchmarks with several threads of their own pass `threaded` and get no
+// counters, the same as runs with several benchmark threads. Setup in the loop
+// goes between pause() and resume(), which stop the counters with the timer.
+class PerfCounters {
+  public:
+#if defined(NETADDR_PERF_COUNTERS) && defined(__linux__)
+    explicit PerfCounters(benchmark::State& state, bool threaded = false)
+        : state(state) {
+        if (!threaded && state.threads() == 1) {
+            leader = group().fds[0];
+        }
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    ~PerfCounters() {
+        if (leader < 0) {
+            return;
+        }
+
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        Reading reading;
+        auto size = read(leader, &reading, sizeof(reading));
+        if (size < (ssize_t)sizeof(std::uint64_t) * 3 || reading.running == 0) {
+            return;
+        }
+
+        // the kernel multiplexes groups which don't fit the PMU
+        auto& events = group();
+        double scale = (double)reading.enabled / reading.running;
+        double values[Events] = {};
+        for (std::size_t i = 0; i < reading.count && i < Events; ++i) {
+            values[events.slots[i]] = reading.values[i] * scale;
+        }
+
+        auto it = state.counters.find("items_per_second");
+        double items = (it != state.counters.end() && it->second.value > 0)
+                           ? it->second.value
+                           : (double)state.iterations();
+
+        if (values[CYCLES] > 0) {
+            state.counters["IPC"] = values[INSTRUCTIONS] / values[CYCLES];
+        }
+        for (std::size_t i = 0; i < Events; ++i) {
+            if (events.fds[i] >= 0) {
+                state.counters[names[i]] = values[i] / items;
+            }
+        }
+    }
+
+    void pause() {
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+        state.PauseTiming();
+    }
+
+    void resume() {
+        state.ResumeTiming();
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+#else
+    explicit PerfCounters(benchmark::State& state, bool = false) : state(state) {}
+
+    void pause() { state.PauseTiming(); }
+
+    void resume() { state.ResumeTiming(); }
+#endif
+
+    PerfCounters(const PerfCounters&) = delete;
+
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+#if defined(NETADDR_PERF_COUNTERS) && defined(__linux__)
+  private:
+    enum Event : std::size_t {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        LLC_MISSES,
+        Events,
+    };
+
+    static constexpr const char* names[Events] = {
+        "cycles/item",     "instructions/item", "branch-misses/item",
+        "L1D-misses/item", "LLC-misses/item",
+    };
+
+    struct Group {
+        // the first one leads the group, -1 for events the CPU or the kernel
+        // doesn't provide
+        int fds[Events];
+        // events in the order of reading
+        std::size_t slots[Events];
+    };
+
+    // PERF_FORMAT_GROUP with the enabled and running times
+    struct Reading {
+        std::uint64_t count;
+        std::uint64_t enabled;
+        std::uint64_t running;
+        std::uint64_t values[Events];
+    };
+
+    // Events are opened once for the process, disabled until a benchmark runs
+    static const Group& group() {
+        static const Group value = open();
+        return value;
+    }
+
+    static Group open() {
+        constexpr auto Cache = [](std::uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const std::pair<std::uint32_t, std::uint64_t> configs[Events] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_LL)},
+        };
+
+        Group value;
+        std::size_t opened = 0;
+        for (std::size_t i = 0; i < Events; ++i) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = configs[i].first;
+            attr.config = configs[i].second;
+            attr.disabled = (i == 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            int leader = (i == 0) ? -1 : value.fds[0];
+            value.fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+
+            if (value.fds[i] >= 0) {
+                value.slots[opened++] = (Event)i;
+            } else if (i == 0) {
+                fprintf(stderr, "***WARNING*** perf_event_open: %s, no counters\n",
+                        strerror(errno));
+                for (auto& fd : value.fds) {
+                    fd = -1;
+                }
+                break;
+            }
+        }
+
+        return value;
+    }
+
+    // -1 if counters are off
+    int leader = -1;
+#endif
+
+  private:
+    benchmark::State& state;
+};
+
+} // namespace netaddr
+
+#endif
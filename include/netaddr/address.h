@@ -14,12 +14,57 @@ class Address : public Subnet {
 
     Address(const std::string_view input) : Address() {
         suggest(input);
-        parse(input);
+        raise(parse(input));
+    }
+
+    // Loads straight from padded input, see PaddedStringView
+    explicit Address(PaddedStringView input) : Address() {
+        suggest(input);
+        raise(parse(input));
     }
 
     ~Address() = default;
+
+    // Same as the constructor, but reports malformed input instead of throwing
+    static Result<Address> tryParse(std::string_view input) noexcept {
+        return make(input);
+    }
+
+    static Result<Address> tryParse(PaddedStringView input) noexcept {
+        return make(input);
+    }
+
+    // Same as the constructor in constant expressions, see Subnet::parseConst()
+    static constexpr Address parseConst(std::string_view input) {
+        return Address(literal(input, false));
+    }
+
+  private:
+    template <typename View>
+    static Result<Address> make(View input) noexcept {
+        Address address;
+
+        address.suggest(input);
+        auto error = address.parse(input);
+        if (error != Error::NONE) {
+            return error;
+        }
+
+        return address;
+    }
+
+    constexpr explicit Address(const Subnet& subnet) noexcept : Subnet(subnet) {}
 };
 
+namespace literals {
+
+// "::1"_ip is the same as Address("::1")
+NETADDR_CONSTEVAL Address operator""_ip(const char* input, std::size_t size) {
+    return Address::parseConst({input, size});
+}
+
+} // namespace literals
+
 } // namespace netaddr
 
 #endif
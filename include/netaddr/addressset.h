@@ -0,0 +1,272 @@
+#pragma once
+#ifndef NETADDR_ADDRESSSET_H_
+#define NETADDR_ADDRESSSET_H_
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <netaddr/hash.h>
+#include <netaddr/simd.h>
+
+namespace netaddr {
+
+// Flat open addressing hash map from 16-byte addresses. Slots come in groups of
+// 16 with a control byte each: either a 7-bit tag of the key's hash or a mark
+// of an empty or erased slot. A lookup compares the tag with a whole group at
+// once and touches keys only when tags match. Addresses are keyed by their
+// IPv6 form, so an IPv4 address and the same one mapped to IPv6 are one key.
+template <typename Value>
+class AddressMap {
+  public:
+    AddressMap() = default;
+
+    ~AddressMap() = default;
+
+    std::size_t size() const noexcept { return count; }
+
+    bool empty() const noexcept { return count == 0; }
+
+    std::size_t capacity() const noexcept { return keys.size(); }
+
+    // Makes room for `size` keys without rehashing
+    void reserve(std::size_t size) {
+        if (size > maxLoad(capacity())) {
+            auto slots = Group;
+            while (size > maxLoad(slots)) {
+                slots *= 2;
+            }
+            rehash(slots);
+        }
+    }
+
+    void clear() noexcept {
+        std::fill(control.begin(), control.end(), Tags{});
+        count = 0;
+        erased = 0;
+    }
+
+    // Returns a pointer to the value of `key` and whether it was inserted, the
+    // value of a present key is left as is
+    std::pair<Value*, bool> insert(const Raw& key, const Value& value) {
+        auto hash = Hasher::hash(key);
+        auto slot = find(key, hash);
+        if (slot != npos) {
+            return {at(slot), false};
+        }
+
+        if (count + erased + 1 > maxLoad(capacity())) {
+            // rehashing drops erased slots, so grow only if they are few
+            auto slots = std::max(capacity(), Group);
+            rehash(count + 1 > maxLoad(slots) / 2 ? slots * 2 : slots);
+        }
+
+        slot = vacant(hash);
+        erased -= (tags()[slot] == Erased);
+        tags()[slot] = tag(hash);
+        keys[slot] = key;
+        if constexpr (HasValues) {
+            values[slot] = value;
+        }
+        ++count;
+
+        return {at(slot), true};
+    }
+
+    std::pair<Value*, bool> insert(const Subnet& address, const Value& value) {
+        return insert(Raw(address.addr6()), value);
+    }
+
+    bool erase(const Raw& key) noexcept {
+        auto slot = find(key, Hasher::hash(key));
+        if (slot == npos) {
+            return false;
+        }
+
+        tags()[slot] = Erased;
+        --count;
+        ++erased;
+
+        return true;
+    }
+
+    bool erase(const Subnet& address) noexcept { return erase(Raw(address.addr6())); }
+
+    Value* find(const Raw& key) noexcept {
+        auto slot = find(key, Hasher::hash(key));
+        return slot == npos ? nullptr : at(slot);
+    }
+
+    const Value* find(const Raw& key) const noexcept {
+        return const_cast<AddressMap*>(this)->find(key);
+    }
+
+    const Value* find(const Subnet& address) const noexcept {
+        return find(Raw(address.addr6()));
+    }
+
+    bool contains(const Raw& key) const noexcept {
+        return find(key, Hasher::hash(key)) != npos;
+    }
+
+    bool contains(const Subnet& address) const noexcept {
+        return contains(Raw(address.addr6()));
+    }
+
+  private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+    static constexpr std::size_t Group = sizeof(__m128i);
+    static constexpr bool HasValues = !std::is_empty_v<Value>;
+    // both have the sign bit set unlike tags
+    static constexpr std::int8_t Empty = -128;
+    static constexpr std::int8_t Erased = -2;
+
+    // at most 7/8 of slots are taken
+    static std::size_t maxLoad(std::size_t slots) noexcept { return slots - slots / 8; }
+
+    static std::int8_t tag(std::uint64_t hash) noexcept {
+        return (std::int8_t)(hash >> (64 - 7));
+    }
+
+    Value* at(std::size_t slot) noexcept {
+        if constexpr (HasValues) {
+            return &values[slot];
+        } else {
+            static Value nothing;
+            return &nothing;
+        }
+    }
+
+    std::int8_t* tags() noexcept { return (std::int8_t*)control.data(); }
+
+    __m128i group(std::size_t index) const noexcept {
+        return _mm_load_si128((const __m128i*)&control[index]);
+    }
+
+    // Groups are probed in triangular order, which visits every one of them
+    // since their number is a power of two
+    std::size_t find(const Raw& key, std::uint64_t hash) const noexcept {
+        if (keys.empty()) {
+            return npos;
+        }
+
+        const auto groups = keys.size() / Group;
+        const auto needle = _mm_set1_epi8(tag(hash));
+        const auto empty = _mm_set1_epi8(Empty);
+        const auto k = _mm_loadu_si128((const __m128i*)&key.data);
+
+        auto index = hash & (groups - 1);
+        for (std::size_t step = 1; step <= groups; ++step) {
+            auto v = group(index);
+            auto matched = (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+
+            for (; matched; matched &= matched - 1) {
+                auto slot = index * Group + simd::lowestBit(matched);
+                auto other = _mm_loadu_si128((const __m128i*)&keys[slot].data);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(k, other)) == 0xFFFF) {
+                    return slot;
+                }
+            }
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, empty))) {
+                return npos;
+            }
+
+            index = (index + step) & (groups - 1);
+        }
+
+        return npos;
+    }
+
+    // The first empty or erased slot of the probe sequence, there must be one
+    std::size_t vacant(std::uint64_t hash) const noexcept {
+        const auto groups = keys.size() / Group;
+
+        auto index = hash & (groups - 1);
+        for (std::size_t step = 1;; ++step) {
+            auto free = (std::uint32_t)_mm_movemask_epi8(group(index));
+            if (free) {
+                return index * Group + simd::lowestBit(free);
+            }
+
+            index = (index + step) & (groups - 1);
+        }
+    }
+
+    void rehash(std::size_t slots) {
+        auto oldControl = std::move(control);
+        auto oldKeys = std::move(keys);
+        auto oldValues = std::move(values);
+
+        control.assign(slots / Group, Tags{});
+        keys.assign(slots, Raw());
+        if constexpr (HasValues) {
+            values.assign(slots, Value());
+        }
+        erased = 0;
+
+        auto* oldTags = (const std::int8_t*)oldControl.data();
+        for (std::size_t i = 0; i < oldKeys.size(); ++i) {
+            if (oldTags[i] >= 0) {
+                auto hash = Hasher::hash(oldKeys[i]);
+                auto slot = vacant(hash);
+
+                tags()[slot] = tag(hash);
+                keys[slot] = oldKeys[i];
+                if constexpr (HasValues) {
+                    values[slot] = std::move(oldValues[i]);
+                }
+            }
+        }
+    }
+
+    // control bytes of a group
+    struct alignas(sizeof(__m128i)) Tags {
+        Tags() noexcept { std::fill(std::begin(bytes), std::end(bytes), Empty); }
+
+        std::int8_t bytes[Group];
+    };
+
+    std::vector<Tags> control;
+    std::vector<Raw> keys;
+    std::vector<Value> values;
+    std::size_t count = 0;
+    std::size_t erased = 0;
+};
+
+// Set of addresses on top of AddressMap without values
+class AddressSet {
+  public:
+    std::size_t size() const noexcept { return map.size(); }
+
+    bool empty() const noexcept { return map.empty(); }
+
+    std::size_t capacity() const noexcept { return map.capacity(); }
+
+    void reserve(std::size_t size) { map.reserve(size); }
+
+    void clear() noexcept { map.clear(); }
+
+    // Returns whether `key` wasn't there
+    bool insert(const Raw& key) { return map.insert(key, {}).second; }
+
+    bool insert(const Subnet& address) { return map.insert(address, {}).second; }
+
+    bool erase(const Raw& key) noexcept { return map.erase(key); }
+
+    bool erase(const Subnet& address) noexcept { return map.erase(address); }
+
+    bool contains(const Raw& key) const noexcept { return map.contains(key); }
+
+    bool contains(const Subnet& address) const noexcept { return map.contains(address); }
+
+  private:
+    struct Nothing {};
+
+    AddressMap<Nothing> map;
+};
+
+} // namespace netaddr
+
+#endif
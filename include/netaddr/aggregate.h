@@ -0,0 +1,166 @@
+#pragma once
+#ifndef NETADDR_AGGREGATE_H_
+#define NETADDR_AGGREGATE_H_
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// Reduces lists of subnets to the minimal ones which contain the same
+// addresses in terms of Subnet::contains
+class Aggregator {
+  public:
+    // Drops empty subnets and subnets contained by others, merges pairs of
+    // sibling subnets into their parent and sorts the rest by address. IPv4 and
+    // IPv6 subnets never merge with each other. IPv6 hosts mapped to IPv4
+    // aren't merged either, since there are no wider mapped IPv6 subnets, but
+    // they are dropped if an IPv4 or IPv6 subnet contains them.
+    static void aggregate(std::vector<Subnet>& subnets) {
+        std::vector<Entry> v4, v6, mapped;
+
+        for (const auto& subnet : subnets) {
+            if (!subnet.v4() && !subnet.v6()) {
+                continue;
+            }
+
+            auto& family = subnet.v4() ? v4 : (subnet.mapped() ? mapped : v6);
+            family.push_back(entry(subnet));
+        }
+
+        reduce(v4, Subnet::IPv4PrefixOffset);
+        reduce(v6, 0);
+
+        std::sort(mapped.begin(), mapped.end());
+        mapped.erase(std::unique(mapped.begin(), mapped.end()), mapped.end());
+        mapped.erase(std::remove_if(mapped.begin(), mapped.end(),
+                                    [&v4, &v6](const Entry& host) {
+                                        return covered(v4, host) || covered(v6, host);
+                                    }),
+                     mapped.end());
+
+        subnets.clear();
+        subnets.reserve(v4.size() + v6.size() + mapped.size());
+
+        using Protocol = Subnet::Protocol;
+        for (const auto& item : v4) {
+            subnets.push_back(make(item, Protocol::IPV4));
+        }
+        for (const auto& item : v6) {
+            subnets.push_back(make(item, Protocol::IPV6));
+        }
+        for (const auto& item : mapped) {
+            subnets.push_back(make(item, Protocol::IPV6));
+        }
+
+        std::sort(subnets.begin(), subnets.end());
+    }
+
+  private:
+    // masked address in host order halves, so that it sorts in network order
+    struct Entry {
+        std::uint64_t hi;
+        std::uint64_t lo;
+        Subnet::Prefix prefix;
+
+        bool operator<(const Entry& other) const noexcept {
+            return std::tie(hi, lo, prefix) < std::tie(other.hi, other.lo, other.prefix);
+        }
+
+        bool operator==(const Entry& other) const noexcept {
+            return hi == other.hi && lo == other.lo && prefix == other.prefix;
+        }
+    };
+
+    static constexpr std::size_t QwordBits = 64;
+
+    static Entry entry(const Subnet& subnet) noexcept {
+        return {subnet.raw().qword(0), subnet.raw().qword(1), subnet.length()};
+    }
+
+    // mapped IPv6 hosts get their flag back from Subnet
+    static Subnet make(const Entry& item, Subnet::Protocol proto) noexcept {
+        Raw address;
+
+        address.data.dwords[0] = htonl((std::uint32_t)(item.hi >> 32));
+        address.data.dwords[1] = htonl((std::uint32_t)item.hi);
+        address.data.dwords[2] = htonl((std::uint32_t)(item.lo >> 32));
+        address.data.dwords[3] = htonl((std::uint32_t)item.lo);
+
+        return Subnet(address, item.prefix, proto);
+    }
+
+    // host order mask of the upper 64 bits of a prefix of length `prefix`
+    static std::uint64_t mask(Subnet::Prefix prefix) noexcept {
+        if (prefix == 0) {
+            return 0;
+        }
+        return prefix >= QwordBits ? ~0ULL : ~0ULL << (QwordBits - prefix);
+    }
+
+    static bool covers(const Entry& parent, const Entry& child) noexcept {
+        auto maskHi = mask(parent.prefix);
+        auto maskLo = mask(parent.prefix > QwordBits ? parent.prefix - QwordBits : 0);
+
+        return parent.prefix <= child.prefix && (child.hi & maskHi) == parent.hi &&
+               (child.lo & maskLo) == parent.lo;
+    }
+
+    // Whether `lhs` is the lower half of a subnet and `rhs` is the upper one
+    static bool siblings(const Entry& lhs, const Entry& rhs) noexcept {
+        if (lhs.prefix != rhs.prefix) {
+            return false;
+        }
+
+        auto bit = lhs.prefix - 1;
+        std::uint64_t flipHi = 0, flipLo = 0;
+        if (bit < QwordBits) {
+            flipHi = 1ULL << (QwordBits - 1 - bit);
+        } else {
+            flipLo = 1ULL << (2 * QwordBits - 1 - bit);
+        }
+
+        return !(lhs.hi & flipHi) && !(lhs.lo & flipLo) && (lhs.hi ^ flipHi) == rhs.hi &&
+               (lhs.lo ^ flipLo) == rhs.lo;
+    }
+
+    // Sorts `entries` and reduces them in one sweep: every entry is either
+    // contained by the last kept one or follows all of them, and merged parents
+    // may merge again with the entry before them. Prefixes never get shorter
+    // than `minPrefix`.
+    static void reduce(std::vector<Entry>& entries, Subnet::Prefix minPrefix) {
+        std::sort(entries.begin(), entries.end());
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (kept && covers(entries[kept - 1], entries[i])) {
+                continue;
+            }
+
+            entries[kept++] = entries[i];
+
+            while (kept >= 2 && entries[kept - 1].prefix > minPrefix &&
+                   siblings(entries[kept - 2], entries[kept - 1])) {
+                --kept;
+                entries[kept - 1].prefix--;
+            }
+        }
+
+        entries.resize(kept);
+    }
+
+    // Whether any of sorted disjoint `entries` contains `host`
+    static bool covered(const std::vector<Entry>& entries, const Entry& host) noexcept {
+        auto it = std::upper_bound(entries.begin(), entries.end(), host);
+        return it != entries.begin() && covers(*(it - 1), host);
+    }
+};
+
+inline void aggregate(std::vector<Subnet>& subnets) { Aggregator::aggregate(subnets); }
+
+} // namespace netaddr
+
+#endif
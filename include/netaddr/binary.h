@@ -0,0 +1,310 @@
+#pragma once
+#ifndef NETADDR_BINARY_H_
+#define NETADDR_BINARY_H_
+
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include <netaddr/compactsubnet.h>
+#include <netaddr/mappedfile.h>
+#include <netaddr/subnet4.h>
+
+namespace netaddr {
+
+template <typename Entry, typename Value = void>
+class MappedTable;
+
+// File format of arrays of addresses or subnets, optionally with a value per
+// entry, which is used as is after mapping into memory. A 64-byte header is
+// followed by the entries and then by the values, both sections start at
+// multiples of 64 bytes. Entries are Raw, CompactSubnet, CompactSubnet4 or
+// Subnet4, values are any trivially copyable type, both written in the byte
+// order of the host. Every supported target is little-endian, and the header
+// records the order to reject foreign files.
+class BinaryFormat {
+  public:
+    static constexpr std::uint32_t Version = 1;
+    static constexpr std::size_t Alignment = 64;
+
+    enum class Kind : std::uint32_t {
+        RAW = 1,
+        COMPACT_SUBNET = 2,
+        COMPACT_SUBNET4 = 3,
+        SUBNET4 = 4,
+    };
+
+    enum class Flags : std::uint32_t {
+        CHECKSUM = (1 << 0),
+    };
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t order;
+        Kind kind;
+        std::uint32_t entrySize;
+        std::uint32_t valueSize;
+        std::uint32_t flags;
+        std::uint64_t count;
+        // offsets of sections from the start of the file
+        std::uint64_t entries;
+        std::uint64_t values;
+        // CRC32C of everything after the header if CHECKSUM is set
+        std::uint32_t checksum;
+        std::uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == Alignment, "size of Header must be Alignment");
+
+    template <typename Entry>
+    static constexpr Kind kind() noexcept {
+        static_assert(std::is_same_v<Entry, Raw> ||
+                          std::is_same_v<Entry, CompactSubnet> ||
+                          std::is_same_v<Entry, CompactSubnet4> ||
+                          std::is_same_v<Entry, Subnet4>,
+                      "entries must be Raw, CompactSubnet, CompactSubnet4 or Subnet4");
+
+        if constexpr (std::is_same_v<Entry, Raw>) {
+            return Kind::RAW;
+        } else if constexpr (std::is_same_v<Entry, CompactSubnet>) {
+            return Kind::COMPACT_SUBNET;
+        } else if constexpr (std::is_same_v<Entry, CompactSubnet4>) {
+            return Kind::COMPACT_SUBNET4;
+        } else {
+            return Kind::SUBNET4;
+        }
+    }
+
+    template <typename Value>
+    static constexpr std::size_t sizeOf() noexcept {
+        if constexpr (std::is_void_v<Value>) {
+            return 0;
+        } else {
+            static_assert(std::is_trivially_copyable_v<Value>,
+                          "values must be trivially copyable");
+            return sizeof(Value);
+        }
+    }
+
+    // Writes `count` entries and, unless `values` is null, their values to
+    // `path`. Throws std::runtime_error if the file can't be written or
+    // `count` entries don't fit in memory.
+    template <typename Entry, typename Value = void>
+    static void write(const std::string& path, const Entry* entries, std::size_t count,
+                      const Value* values = nullptr, bool checksum = true) {
+        std::size_t valueSize = values ? sizeOf<Value>() : 0;
+
+        // both sections and their padding must fit in size_t
+        constexpr auto Limit = std::numeric_limits<std::size_t>::max() - 3 * Alignment;
+        if (count > Limit / (sizeof(Entry) + valueSize)) {
+            throw std::runtime_error("too many entries for " + path);
+        }
+
+        std::size_t entryBytes = count * sizeof(Entry);
+        std::size_t valueBytes = count * valueSize;
+
+        Header header = {};
+        memcpy(header.magic, Magic, sizeof(header.magic));
+        header.version = Version;
+        header.order = Order;
+        header.kind = kind<Entry>();
+        header.entrySize = sizeof(Entry);
+        header.valueSize = (std::uint32_t)valueSize;
+        header.count = count;
+        header.entries = sizeof(Header);
+        header.values = align(header.entries + entryBytes);
+
+        std::vector<char> body(align(header.values + valueBytes) - sizeof(Header));
+        std::size_t valuesOffset = header.values - sizeof(Header);
+
+        // the sizes are checked against the body once more to let compilers see
+        // that copies stay inside of it
+        if (count && entryBytes <= valuesOffset &&
+            valueBytes <= body.size() - valuesOffset) {
+            memcpy(body.data(), entries, entryBytes);
+            if (valueSize) {
+                memcpy(body.data() + valuesOffset, values, valueBytes);
+            }
+        }
+
+        if (checksum) {
+            header.flags |= static_cast<std::uint32_t>(Flags::CHECKSUM);
+            header.checksum = crc32c(body.data(), body.size());
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write(body.data(), (std::streamsize)body.size());
+        file.close();
+
+        if (!file) {
+            throw std::runtime_error("can't write " + path);
+        }
+    }
+
+    // Subnets are stored as CompactSubnet
+    template <typename Value = void>
+    static void write(const std::string& path, const Subnet* subnets, std::size_t count,
+                      const Value* values = nullptr, bool checksum = true) {
+        std::vector<CompactSubnet> entries(subnets, subnets + count);
+        write(path, entries.data(), count, values, checksum);
+    }
+
+    static std::uint32_t crc32c(const void* data, std::size_t size,
+                                std::uint32_t seed = 0) noexcept {
+        auto* bytes = (const std::uint8_t*)data;
+        std::uint64_t crc = ~seed;
+
+        for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t)) {
+            std::uint64_t qword;
+            memcpy(&qword, bytes, sizeof(qword));
+            crc = _mm_crc32_u64(crc, qword);
+            bytes += sizeof(qword);
+        }
+        for (; size; --size) {
+            crc = _mm_crc32_u8((std::uint32_t)crc, *bytes++);
+        }
+
+        return ~(std::uint32_t)crc;
+    }
+
+    static constexpr std::uint64_t align(std::uint64_t offset) noexcept {
+        return (offset + Alignment - 1) / Alignment * Alignment;
+    }
+
+  private:
+    static constexpr char Magic[8] = {'N', 'E', 'T', 'A', 'D', 'D', 'R', '\0'};
+    static constexpr std::uint32_t Order = 0x01020304;
+
+    template <typename Entry, typename Value>
+    friend class MappedTable;
+};
+
+// Read-only view of a file written by BinaryFormat::write(), which is mapped
+// into memory and neither copied nor parsed. `Entry` and `Value` must be the
+// types the file was written with, `Value` is void for files without values.
+// Pages are read on first access, so opening costs the same for any size
+// unless the checksum is verified.
+template <typename Entry, typename Value>
+class MappedTable {
+  public:
+    using value_type = Entry;
+    using const_iterator = const Entry*;
+
+    // Throws std::runtime_error if the file can't be mapped, is malformed or
+    // holds other types. Checksums are verified if `verify` is set. Only the
+    // header and bounds of sections are checked otherwise, not entries: prefix
+    // lengths out of range of corrupt files give host subnets.
+    explicit MappedTable(const std::string& path, bool verify = true) : file(path) {
+        check(verify);
+    }
+
+    MappedTable(MappedTable&& other) noexcept
+        : file(std::move(other.file)), header(other.header) {
+        other.header = nullptr;
+    }
+
+    MappedTable& operator=(MappedTable&& other) noexcept {
+        file = std::move(other.file);
+        header = other.header;
+        other.header = nullptr;
+        return *this;
+    }
+
+    MappedTable(const MappedTable&) = delete;
+
+    MappedTable& operator=(const MappedTable&) = delete;
+
+    ~MappedTable() = default;
+
+    std::size_t size() const noexcept { return header ? header->count : 0; }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    const Entry* data() const noexcept {
+        return header ? (const Entry*)(file.data() + header->entries) : nullptr;
+    }
+
+    const_iterator begin() const noexcept { return data(); }
+
+    const_iterator end() const noexcept { return data() + size(); }
+
+    const Entry& operator[](std::size_t i) const noexcept { return data()[i]; }
+
+    template <typename V = Value>
+    const V* values() const noexcept {
+        return header ? (const V*)(file.data() + header->values) : nullptr;
+    }
+
+    template <typename V = Value>
+    const V& value(std::size_t i) const noexcept {
+        return values<V>()[i];
+    }
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_span)
+    std::span<const Entry> entries() const noexcept { return {data(), size()}; }
+#endif
+
+  private:
+    void check(bool verify) {
+        using Format = BinaryFormat;
+        auto* base = file.data();
+        auto length = file.size();
+
+        if (length < sizeof(Format::Header)) {
+            throw std::runtime_error("file is too short");
+        }
+
+        auto* head = (const Format::Header*)base;
+        if (memcmp(head->magic, Format::Magic, sizeof(head->magic)) != 0) {
+            throw std::runtime_error("not a netaddr binary file");
+        }
+        if (head->version != Format::Version || head->order != Format::Order) {
+            throw std::runtime_error("unsupported version or byte order");
+        }
+        if (head->kind != Format::kind<Entry>() || head->entrySize != sizeof(Entry) ||
+            head->valueSize != Format::sizeOf<Value>()) {
+            throw std::runtime_error("file holds other types");
+        }
+
+        // sections are within the file, sizes are compared against the room
+        // left, so that no sum of header fields can overflow
+        auto entries = head->entries, values = head->values, count = head->count;
+        bool inside = entries == sizeof(Format::Header) &&
+                      count <= (length - entries) / sizeof(Entry) &&
+                      values % Format::Alignment == 0 && values <= length &&
+                      values >= entries + count * sizeof(Entry) &&
+                      (head->valueSize == 0 ||
+                       count <= (length - values) / head->valueSize);
+        if (!inside) {
+            throw std::runtime_error("sections are out of the file");
+        }
+
+        auto checksum = static_cast<std::uint32_t>(Format::Flags::CHECKSUM);
+        if (verify && (head->flags & checksum)) {
+            auto crc = Format::crc32c(base + sizeof(Format::Header),
+                                      length - sizeof(Format::Header));
+            if (crc != head->checksum) {
+                throw std::runtime_error("checksum mismatch");
+            }
+        }
+
+        header = head;
+    }
+
+    MappedFile file;
+    const BinaryFormat::Header* header = nullptr;
+};
+
+} // namespace netaddr
+
+#endif
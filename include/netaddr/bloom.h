@@ -0,0 +1,211 @@
+#pragma once
+#ifndef NETADDR_BLOOM_H_
+#define NETADDR_BLOOM_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <netaddr/hash.h>
+
+namespace netaddr {
+
+// Blocked Bloom filter of addresses and subnets, a compact front of large
+// exact sets which are mostly missed. A key sets one bit in each of the eight
+// 32-bit words of a 256-bit block picked by its hash, so a probe touches half
+// a cache line and tests all eight bits with a few vector instructions.
+// Subnets are added as their masked addresses, and a lookup masks the address
+// once per distinct prefix length added, longest first.
+class BloomFilter {
+  public:
+    // Sized for `capacity` keys with a share of false positives of `rate` per
+    // prefix length at most
+    explicit BloomFilter(std::size_t capacity, double rate = 0.01) {
+        auto bits = (double)std::max<std::size_t>(capacity, 1) * bitsPerKey(rate);
+        auto size = (std::size_t)std::ceil(bits / BlockBits);
+        blocks.resize(std::max<std::size_t>(size, 1));
+    }
+
+    ~BloomFilter() = default;
+
+    // keys added, repeated ones included
+    std::size_t size() const noexcept { return count; }
+
+    // Memory taken by the bit array
+    std::size_t bytes() const noexcept { return blocks.size() * sizeof(Block); }
+
+    // Expected share of false positives per prefix length at the current load
+    double rate() const noexcept {
+        return falsePositiveRate((double)(blocks.size() * BlockBits) /
+                                 (double)std::max<std::size_t>(count, 1));
+    }
+
+    void insert(const Raw& address) { insert(address, Subnet::IPv6MaxPrefix); }
+
+    // IPv4 subnets are keyed by their mapped IPv6 form, as in Raw
+    void insert(const Subnet& subnet) { insert(subnet.raw(), subnet.length()); }
+
+    // False if `address` surely isn't in any added subnet, true if it's likely to
+    bool mayContain(const Raw& address) const noexcept {
+        for (std::size_t i = 0; i < lengths.size(); ++i) {
+            if (probe(key(address, i), lengths[i])) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool mayContain(const Subnet& address) const noexcept {
+        return mayContain(address.raw());
+    }
+
+    // Looks up `count` addresses at once, prefetching blocks of the longest
+    // prefix length a few addresses ahead as Lpm4 does
+    void mayContain(const Raw* addresses, std::size_t count,
+                    bool* results) const noexcept {
+        constexpr std::size_t Ahead = 16;
+
+        if (lengths.empty()) {
+            std::fill(results, results + count, false);
+            return;
+        }
+
+        for (std::size_t i = 0; i < std::min(Ahead, count); ++i) {
+            prefetch(addresses[i]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i + Ahead < count) {
+                prefetch(addresses[i + Ahead]);
+            }
+            results[i] = mayContain(addresses[i]);
+        }
+    }
+
+    // Share of false positives of a filter with `bitsPerKey` bits per key. Keys
+    // fall into blocks as a Poisson distribution, and a block of `i` keys gives
+    // a false positive if each of the eight bits tested is set.
+    static double falsePositiveRate(double bitsPerKey) noexcept {
+        auto load = BlockBits / std::max(bitsPerKey, 1.0 / BlockBits);
+        auto limit = (std::size_t)(load + 12 * std::sqrt(load) + 32);
+
+        double rate = 0;
+        auto poisson = std::exp(-load);
+        for (std::size_t i = 0; i <= limit; ++i) {
+            rate += poisson * std::pow(1 - std::pow(1 - 1.0 / WordBits, (double)i),
+                                       (double)Words);
+            poisson *= load / (double)(i + 1);
+        }
+
+        return rate;
+    }
+
+    // The least number of bits per key for a share of false positives of `rate`
+    static double bitsPerKey(double rate) noexcept {
+        double lo = 1, hi = BlockBits;
+
+        // bisect, the rate falls as bits grow
+        for (std::size_t i = 0; i < 32; ++i) {
+            auto mid = (lo + hi) / 2;
+            (falsePositiveRate(mid) > rate ? lo : hi) = mid;
+        }
+
+        return hi;
+    }
+
+  private:
+    static constexpr std::size_t WordBits = 32;
+    static constexpr std::size_t Words = 8;
+    static constexpr std::size_t BlockBits = WordBits * Words;
+
+    struct alignas(32) Block {
+        std::uint32_t words[Words] = {};
+    };
+
+    // odd multipliers spreading a hash to the bit of each word
+    alignas(16) static constexpr std::uint32_t Salts[Words] = {
+        0x47B6137B, 0x44974D91, 0x8824AD5B, 0xA2B7289D,
+        0x705495C7, 0x2DF1424B, 0x9EFC4947, 0x5C6BFB31,
+    };
+
+    void insert(const Raw& address, Subnet::Prefix length) {
+        auto it = std::lower_bound(lengths.begin(), lengths.end(), length,
+                                   std::greater<Subnet::Prefix>());
+        auto i = (std::size_t)(it - lengths.begin());
+
+        if (it == lengths.end() || *it != length) {
+            Raw mask;
+            _mm_storeu_si128((__m128i*)&mask, Subnet::bitmask(length));
+
+            lengths.insert(it, length);
+            masks.insert(masks.begin() + i, mask);
+        }
+
+        auto hash = Hasher::hash(key(address, i), length);
+        auto& found = blocks[index(hash)];
+
+        auto lo = _mm_load_si128((const __m128i*)&found.words[0]);
+        auto hi = _mm_load_si128((const __m128i*)&found.words[4]);
+        lo = _mm_or_si128(lo, bits((std::uint32_t)hash, 0));
+        hi = _mm_or_si128(hi, bits((std::uint32_t)hash, 1));
+        _mm_store_si128((__m128i*)&found.words[0], lo);
+        _mm_store_si128((__m128i*)&found.words[4], hi);
+
+        ++count;
+    }
+
+    // `address` masked by prefix length `i` of `lengths`
+    Raw key(const Raw& address, std::size_t i) const noexcept {
+        Raw masked;
+
+        auto v = _mm_loadu_si128((const __m128i*)&address);
+        auto mask = _mm_loadu_si128((const __m128i*)&masks[i]);
+        _mm_storeu_si128((__m128i*)&masked, _mm_and_si128(v, mask));
+        return masked;
+    }
+
+    // The block of the upper half of a hash, bits of each word of the lower one
+    std::size_t index(std::uint64_t hash) const noexcept {
+        return (std::size_t)((hash >> 32) * blocks.size() >> 32);
+    }
+
+    // One bit per word of `half` of a block at the top 5 bits of the salted
+    // hash. SSE has no variable shifts, so the bit comes from a float power
+    // of two converted to an integer; 2^31 overflows the conversion, which
+    // gives 0x80000000 as needed.
+    static __m128i bits(std::uint32_t hash, std::size_t half) noexcept {
+        auto salt = _mm_load_si128((const __m128i*)&Salts[half * 4]);
+        auto v = _mm_mullo_epi32(_mm_set1_epi32((int)hash), salt);
+
+        v = _mm_slli_epi32(_mm_srli_epi32(v, 27), 23);
+        v = _mm_add_epi32(v, _mm_set1_epi32(0x3F800000));
+        return _mm_cvttps_epi32(_mm_castsi128_ps(v));
+    }
+
+    bool probe(const Raw& key, Subnet::Prefix length) const noexcept {
+        auto hash = Hasher::hash(key, length);
+        auto& found = blocks[index(hash)];
+
+        auto lo = _mm_load_si128((const __m128i*)&found.words[0]);
+        auto hi = _mm_load_si128((const __m128i*)&found.words[4]);
+
+        return _mm_testc_si128(lo, bits((std::uint32_t)hash, 0)) &
+               _mm_testc_si128(hi, bits((std::uint32_t)hash, 1));
+    }
+
+    void prefetch(const Raw& address) const noexcept {
+        auto hash = Hasher::hash(key(address, 0), lengths[0]);
+        _mm_prefetch((const char*)&blocks[index(hash)], _MM_HINT_T0);
+    }
+
+    std::vector<Block> blocks;
+    // distinct prefix lengths added, longest first, and their netmasks
+    std::vector<Subnet::Prefix> lengths;
+    std::vector<Raw> masks;
+    std::size_t count = 0;
+};
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,311 @@
+#pragma once
+#ifndef NETADDR_CLASSIFY_H_
+#define NETADDR_CLASSIFY_H_
+
+#include <iterator>
+
+#include <netaddr/address.h>
+
+namespace netaddr {
+
+// Classification of addresses by the IANA IPv4 and IPv6 Special-Purpose
+// Address Registries (RFC 6890). The ranges are compiled into tables of masks
+// and values, so an address is matched against four IPv4 or two IPv6 ranges
+// per SIMD compare and the categories of matching ranges are merged without
+// branches. IPv4 addresses mapped to IPv6 are classified as IPv4.
+class Classifier {
+  public:
+    using Categories = std::uint32_t;
+
+    enum class Category : Categories {
+        // "this network" and the unspecified address
+        UNSPECIFIED = (1 << 0),
+        LOOPBACK = (1 << 1),
+        // RFC 1918
+        PRIVATE = (1 << 2),
+        // carrier-grade NAT, RFC 6598
+        SHARED = (1 << 3),
+        LINK_LOCAL = (1 << 4),
+        MULTICAST = (1 << 5),
+        // RFC 4193
+        UNIQUE_LOCAL = (1 << 6),
+        DOCUMENTATION = (1 << 7),
+        BENCHMARKING = (1 << 8),
+        // IETF protocol assignments
+        PROTOCOL = (1 << 9),
+        // NAT64, 6to4 and Teredo
+        TRANSITION = (1 << 10),
+        DISCARD = (1 << 11),
+        RESERVED = (1 << 12),
+        BROADCAST = (1 << 13),
+        // never a source on the Internet: not globally reachable as of the
+        // registries, multicast and reserved
+        BOGON = (1 << 14),
+    };
+
+    struct Range {
+        std::string_view subnet;
+        Categories categories;
+    };
+
+    // Categories of `address`, zero for global unicast ones
+    static Categories classify(const Raw& address) noexcept {
+        if (mapped(address)) {
+            return finish(lookup4(address.data.dwords[3]));
+        }
+
+        return finish(lookup6(address));
+    }
+
+    // Categories of the first address of `subnet`, IPv4 ranges apply to IPv4
+    // and mapped subnets only
+    static Categories classify(const Subnet& subnet) noexcept {
+        if (subnet.mapped()) {
+            return finish(lookup4(subnet.raw().data.dwords[3]));
+        }
+
+        return finish(lookup6(subnet.raw()));
+    }
+
+    // Classifies `count` addresses of `input` into `output`
+    static void classify(const Raw* input, std::size_t count,
+                         Categories* output) noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            output[i] = classify(input[i]);
+        }
+    }
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_span)
+    static void classify(std::span<const Raw> input, Categories* output) noexcept {
+        classify(input.data(), input.size(), output);
+    }
+#endif
+
+    static constexpr bool has(Categories categories, Category category) noexcept {
+        return categories & static_cast<Categories>(category);
+    }
+
+    static constexpr const char* describe(Category category) noexcept {
+        switch (category) {
+        case Category::UNSPECIFIED:
+            return "unspecified";
+        case Category::LOOPBACK:
+            return "loopback";
+        case Category::PRIVATE:
+            return "private";
+        case Category::SHARED:
+            return "shared";
+        case Category::LINK_LOCAL:
+            return "link-local";
+        case Category::MULTICAST:
+            return "multicast";
+        case Category::UNIQUE_LOCAL:
+            return "unique-local";
+        case Category::DOCUMENTATION:
+            return "documentation";
+        case Category::BENCHMARKING:
+            return "benchmarking";
+        case Category::PROTOCOL:
+            return "protocol";
+        case Category::TRANSITION:
+            return "transition";
+        case Category::DISCARD:
+            return "discard";
+        case Category::RESERVED:
+            return "reserved";
+        case Category::BROADCAST:
+            return "broadcast";
+        case Category::BOGON:
+            return "bogon";
+        }
+
+        return "unknown";
+    }
+
+  private:
+    // Globally reachable ranges nested in bogons, they clear BOGON of the
+    // enclosing range
+    static constexpr Categories Reachable = (Categories)1 << 31;
+
+    static constexpr Categories Bogon = static_cast<Categories>(Category::BOGON);
+
+  public:
+    // clang-format off
+    static constexpr Range Ranges4[] = {
+        {"0.0.0.0/8", static_cast<Categories>(Category::UNSPECIFIED) | Bogon},
+        {"10.0.0.0/8", static_cast<Categories>(Category::PRIVATE) | Bogon},
+        {"100.64.0.0/10", static_cast<Categories>(Category::SHARED) | Bogon},
+        {"127.0.0.0/8", static_cast<Categories>(Category::LOOPBACK) | Bogon},
+        {"169.254.0.0/16", static_cast<Categories>(Category::LINK_LOCAL) | Bogon},
+        {"172.16.0.0/12", static_cast<Categories>(Category::PRIVATE) | Bogon},
+        {"192.0.0.0/24", static_cast<Categories>(Category::PROTOCOL) | Bogon},
+        {"192.0.0.9/32", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"192.0.0.10/32", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"192.0.2.0/24", static_cast<Categories>(Category::DOCUMENTATION) | Bogon},
+        {"192.168.0.0/16", static_cast<Categories>(Category::PRIVATE) | Bogon},
+        {"198.18.0.0/15", static_cast<Categories>(Category::BENCHMARKING) | Bogon},
+        {"198.51.100.0/24", static_cast<Categories>(Category::DOCUMENTATION) | Bogon},
+        {"203.0.113.0/24", static_cast<Categories>(Category::DOCUMENTATION) | Bogon},
+        {"224.0.0.0/4", static_cast<Categories>(Category::MULTICAST) | Bogon},
+        {"240.0.0.0/4", static_cast<Categories>(Category::RESERVED) | Bogon},
+        {"255.255.255.255/32", static_cast<Categories>(Category::BROADCAST) | Bogon},
+    };
+
+    static constexpr Range Ranges6[] = {
+        {"::/128", static_cast<Categories>(Category::UNSPECIFIED) | Bogon},
+        {"::1/128", static_cast<Categories>(Category::LOOPBACK) | Bogon},
+        {"64:ff9b::/96", static_cast<Categories>(Category::TRANSITION)},
+        {"64:ff9b:1::/48", static_cast<Categories>(Category::TRANSITION) | Bogon},
+        {"100::/64", static_cast<Categories>(Category::DISCARD) | Bogon},
+        {"2001::/23", static_cast<Categories>(Category::PROTOCOL) | Bogon},
+        {"2001::/32", static_cast<Categories>(Category::TRANSITION) | Reachable},
+        {"2001:1::1/128", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:1::2/128", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:1::3/128", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:2::/48", static_cast<Categories>(Category::BENCHMARKING) | Bogon},
+        {"2001:3::/32", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:4:112::/48", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:20::/28", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:30::/28", static_cast<Categories>(Category::PROTOCOL) | Reachable},
+        {"2001:db8::/32", static_cast<Categories>(Category::DOCUMENTATION) | Bogon},
+        {"2002::/16", static_cast<Categories>(Category::TRANSITION)},
+        {"3fff::/20", static_cast<Categories>(Category::DOCUMENTATION) | Bogon},
+        {"5f00::/16", static_cast<Categories>(Category::PROTOCOL) | Bogon},
+        {"fc00::/7", static_cast<Categories>(Category::UNIQUE_LOCAL) | Bogon},
+        {"fe80::/10", static_cast<Categories>(Category::LINK_LOCAL) | Bogon},
+        {"ff00::/8", static_cast<Categories>(Category::MULTICAST) | Bogon},
+    };
+    // clang-format on
+
+  private:
+    // Masks, values and categories of ranges in lanes of `Lane` bytes, padded
+    // with ranges of no categories to whole vectors
+    template <typename Lane, std::size_t Count>
+    struct Table {
+        static constexpr std::size_t Lanes = sizeof(__m128i) / sizeof(Lane);
+        static constexpr std::size_t Size = (Count + Lanes - 1) / Lanes * Lanes;
+
+        alignas(16) Lane masks[Size] = {};
+        alignas(16) Lane values[Size] = {};
+        alignas(16) Lane categories[Size] = {};
+    };
+
+    // Netmask bytes of a prefix length of Subnet::length(), as Subnet::bitmask()
+    // gives them at run time
+    static constexpr Array<std::uint8_t> netmask(Subnet::Prefix length) noexcept {
+        Array<std::uint8_t> bytes{};
+        for (std::size_t i = 0; i < SizeIPv6; ++i) {
+            auto ones = (length > i * 8) ? length - i * 8 : 0;
+            bytes[i] = (ones >= 8) ? 0xFF : (std::uint8_t)(0xFF00 >> ones);
+        }
+
+        return bytes;
+    }
+
+    // `width` bytes of `bytes` at `offset` as loaded from memory on x86
+    static constexpr std::uint64_t load(const Array<std::uint8_t>& bytes,
+                                        std::size_t offset, std::size_t width) noexcept {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < width; ++i) {
+            value |= (std::uint64_t)bytes[offset + i] << (i * 8);
+        }
+
+        return value;
+    }
+
+    static constexpr auto make4() {
+        Table<std::uint32_t, std::size(Ranges4)> table;
+
+        for (std::size_t i = 0; i < std::size(Ranges4); ++i) {
+            auto subnet = Subnet::parseConst(Ranges4[i].subnet);
+            auto offset = OffsetIPv4Dword * SizeIPv4;
+            auto mask = netmask(subnet.length());
+            auto& addr = subnet.raw().data.bytes;
+
+            table.masks[i] = (std::uint32_t)load(mask, offset, SizeIPv4);
+            table.values[i] = (std::uint32_t)load(addr, offset, SizeIPv4);
+            table.categories[i] = Ranges4[i].categories;
+        }
+
+        return table;
+    }
+
+    // halves of addresses go to separate tables, so that a vector of each
+    // holds the same half of two ranges
+    static constexpr auto make6(std::size_t half) {
+        Table<std::uint64_t, std::size(Ranges6)> table;
+
+        for (std::size_t i = 0; i < std::size(Ranges6); ++i) {
+            auto subnet = Subnet::parseConst(Ranges6[i].subnet);
+            auto offset = half * sizeof(std::uint64_t);
+            auto mask = netmask(subnet.length());
+            auto& addr = subnet.raw().data.bytes;
+
+            table.masks[i] = load(mask, offset, sizeof(std::uint64_t));
+            table.values[i] = load(addr, offset, sizeof(std::uint64_t));
+            table.categories[i] = Ranges6[i].categories;
+        }
+
+        return table;
+    }
+
+    // see Subnet::mapping6()
+    static bool mapped(const Raw& address) noexcept {
+        return address.data.qwords[0] == 0 && address.data.dwords[2] == htonl(0xFFFF);
+    }
+
+    static Categories lookup4(std::uint32_t address) noexcept {
+        static constexpr auto table = make4();
+
+        auto v = _mm_set1_epi32((int)address);
+        auto result = _mm_setzero_si128();
+
+        for (std::size_t i = 0; i < table.Size; i += table.Lanes) {
+            auto mask = _mm_load_si128((const __m128i*)&table.masks[i]);
+            auto value = _mm_load_si128((const __m128i*)&table.values[i]);
+            auto categories = _mm_load_si128((const __m128i*)&table.categories[i]);
+
+            auto eq = _mm_cmpeq_epi32(_mm_and_si128(v, mask), value);
+            result = _mm_or_si128(result, _mm_and_si128(eq, categories));
+        }
+
+        result = _mm_or_si128(result, _mm_unpackhi_epi64(result, result));
+        result = _mm_or_si128(result, _mm_srli_epi64(result, 32));
+        return (Categories)_mm_cvtsi128_si32(result);
+    }
+
+    static Categories lookup6(const Raw& address) noexcept {
+        static constexpr auto high = make6(0);
+        static constexpr auto low = make6(1);
+
+        auto hi = _mm_set1_epi64x((long long)address.data.qwords[0]);
+        auto lo = _mm_set1_epi64x((long long)address.data.qwords[1]);
+        auto result = _mm_setzero_si128();
+
+        for (std::size_t i = 0; i < high.Size; i += high.Lanes) {
+            auto eqHi = _mm_cmpeq_epi64(
+                _mm_and_si128(hi, _mm_load_si128((const __m128i*)&high.masks[i])),
+                _mm_load_si128((const __m128i*)&high.values[i]));
+            auto eqLo = _mm_cmpeq_epi64(
+                _mm_and_si128(lo, _mm_load_si128((const __m128i*)&low.masks[i])),
+                _mm_load_si128((const __m128i*)&low.values[i]));
+            auto categories = _mm_load_si128((const __m128i*)&high.categories[i]);
+
+            auto eq = _mm_and_si128(eqHi, eqLo);
+            result = _mm_or_si128(result, _mm_and_si128(eq, categories));
+        }
+
+        result = _mm_or_si128(result, _mm_unpackhi_epi64(result, result));
+        return (Categories)_mm_cvtsi128_si32(result);
+    }
+
+    // drops BOGON of reachable ranges nested in bogons
+    static constexpr Categories finish(Categories categories) noexcept {
+        auto reachable = (Categories)0 - (categories >> 31);
+        return categories & ~(reachable & Bogon) & ~Reachable;
+    }
+};
+
+} // namespace netaddr
+
+#endif
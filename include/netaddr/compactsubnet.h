@@ -0,0 +1,165 @@
+#pragma once
+#ifndef NETADDR_COMPACTSUBNET_H_
+#define NETADDR_COMPACTSUBNET_H_
+
+#include <stdexcept>
+
+#include <netaddr/subnet.h>
+#include <netaddr/subnet4.h>
+
+namespace netaddr {
+
+// Subnet packed into 17 bytes without alignment: the masked address and a
+// byte encoding both the protocol and the prefix length. The mask is computed
+// when needed and mapping is derived, since mapped IPv6 subnets are always hosts.
+class CompactSubnet {
+  public:
+    using Prefix = Subnet::Prefix;
+
+    bool empty() const noexcept { return code == None; }
+
+    bool v4() const noexcept { return code >= IPv4Base && code != None; }
+
+    bool v6() const noexcept { return code <= Subnet::IPv6MaxPrefix; }
+
+    // IPv4 or IPv6 mapped to IPv4 according RFC4038, only hosts are mapped as
+    // Subnet does
+    bool mapped() const noexcept {
+        if (v4()) {
+            return true;
+        }
+
+        auto head = _mm_xor_si128(load(), _mm_setr_epi32(0, 0, (int)htonl(0xFFFF), 0));
+        return code == Subnet::IPv6MaxPrefix &&
+               _mm_testz_si128(head, _mm_setr_epi32(-1, -1, -1, 0));
+    }
+
+    Prefix cidr() const noexcept {
+        return v6() ? code : (v4() ? code - IPv4Base : 0);
+    }
+
+    bool operator==(const CompactSubnet& other) const noexcept {
+        return code == other.code && memcmp(addr, other.addr, sizeof(addr)) == 0;
+    }
+
+    bool operator!=(const CompactSubnet& other) const noexcept {
+        return !(*this == other);
+    }
+
+    bool belongs(const CompactSubnet& parent) const noexcept {
+        return parent.contains(*this);
+    }
+
+    bool contains(const CompactSubnet& child) const noexcept {
+        auto len = prefix();
+        if (child.prefix() < len || empty() || child.empty()) {
+            return false;
+        }
+
+        // IPv4 and IPv6 meet only at IPv6 hosts mapped to IPv4
+        if (v4() != child.v4() && !(v4() ? child.mapped() : mapped())) {
+            return false;
+        }
+
+        auto diff = _mm_xor_si128(load(), child.load());
+        return _mm_testz_si128(diff, Subnet::bitmask(len));
+    }
+
+    CompactSubnet() noexcept = default;
+
+    explicit CompactSubnet(const Subnet& subnet) noexcept {
+        memcpy(addr, &subnet.raw().data, sizeof(addr));
+
+        if (subnet.v4()) {
+            code = (std::uint8_t)(IPv4Base + subnet.cidr());
+        } else if (subnet.v6()) {
+            code = (std::uint8_t)subnet.length();
+        }
+    }
+
+    ~CompactSubnet() = default;
+
+    Subnet subnet() const noexcept {
+        if (empty()) {
+            return Subnet();
+        }
+
+        Raw address;
+        memcpy(&address.data, addr, sizeof(addr));
+        auto proto = v4() ? Subnet::Protocol::IPV4 : Subnet::Protocol::IPV6;
+
+        return Subnet(address, prefix(), proto);
+    }
+
+  private:
+    static constexpr std::uint8_t IPv4Base = Subnet::IPv6MaxPrefix + 1;
+    static constexpr std::uint8_t None = 0xFF;
+
+    __m128i load() const noexcept { return _mm_loadu_si128((const __m128i*)addr); }
+
+    // prefix length in terms of 128-bit addresses, as Subnet keeps it
+    Prefix prefix() const noexcept {
+        return v6() ? code : code - IPv4Base + Subnet::IPv4PrefixOffset;
+    }
+
+    std::uint8_t addr[SizeIPv6] = {};
+    // 0-128 for IPv6 prefixes, IPv4Base + 0-32 for IPv4 prefixes or None
+    std::uint8_t code = None;
+};
+
+// IPv4 only subnet packed into 5 bytes: the masked address in network order and
+// the prefix length. It is the storage form of Subnet4, which does the
+// arithmetic.
+class CompactSubnet4 {
+  public:
+    using Prefix = Subnet::Prefix;
+
+    Prefix cidr() const noexcept { return prefix; }
+
+    auto addr4() const noexcept {
+        struct in_addr value;
+        memcpy(&value, addr, sizeof(addr));
+        return value;
+    }
+
+    bool operator==(const CompactSubnet4& other) const noexcept {
+        return prefix == other.prefix && memcmp(addr, other.addr, sizeof(addr)) == 0;
+    }
+
+    bool operator!=(const CompactSubnet4& other) const noexcept {
+        return !(*this == other);
+    }
+
+    bool belongs(const CompactSubnet4& parent) const noexcept {
+        return parent.contains(*this);
+    }
+
+    bool contains(const CompactSubnet4& child) const noexcept {
+        return subnet4().contains(child.subnet4());
+    }
+
+    CompactSubnet4() noexcept = default;
+
+    explicit CompactSubnet4(const Subnet4& subnet) noexcept {
+        auto value = subnet.addr4();
+        memcpy(addr, &value, sizeof(addr));
+        prefix = (std::uint8_t)subnet.cidr();
+    }
+
+    // Throws std::invalid_argument for non IPv4 subnets
+    explicit CompactSubnet4(const Subnet& subnet) : CompactSubnet4(Subnet4(subnet)) {}
+
+    ~CompactSubnet4() = default;
+
+    Subnet4 subnet4() const noexcept { return Subnet4(addr4().s_addr, prefix); }
+
+    Subnet subnet() const noexcept { return subnet4().subnet(); }
+
+  private:
+    std::uint8_t addr[SizeIPv4] = {};
+    std::uint8_t prefix = 0;
+};
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef NETADDR_CPU_H_
+#define NETADDR_CPU_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// Functions using instructions beyond the SSE4.2 baseline are compiled for
+// them without -march and called only when Cpu::level() allows
+#ifdef _MSC_VER
+#define NETADDR_TARGET(isa)
+#else
+#define NETADDR_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#define NETADDR_TARGET_AVX2 NETADDR_TARGET("avx2")
+#define NETADDR_TARGET_AVX512 NETADDR_TARGET("avx2,avx512f,avx512bw,avx512vl")
+
+namespace netaddr {
+
+// Instruction sets of kernels chosen at run time. The level is detected once
+// via CPUID and can be lowered, but not raised, with the NETADDR_CPU
+// environment variable set to "scalar", "sse42", "avx2" or "avx512", so that
+// every kernel can be measured on one machine.
+class Cpu {
+  public:
+    enum class Level : std::uint8_t {
+        SCALAR = 0,
+        SSE42,
+        AVX2,
+        AVX512,
+    };
+
+    static Level level() noexcept { return current().load(std::memory_order_relaxed); }
+
+    // The best level of this CPU regardless of overrides
+    static Level supported() noexcept {
+        static const Level value = detect();
+        return value;
+    }
+
+    // Switches kernels to `value` or the best supported level below it, returns
+    // the level in effect
+    static Level setLevel(Level value) noexcept {
+        value = value < supported() ? value : supported();
+        current().store(value, std::memory_order_relaxed);
+        return value;
+    }
+
+    // Level of its name as of NETADDR_CPU, `fallback` for unknown names
+    static Level parse(const char* name, Level fallback) noexcept {
+        for (auto value : {Level::SCALAR, Level::SSE42, Level::AVX2, Level::AVX512}) {
+            if (strcmp(name, describe(value)) == 0) {
+                return value;
+            }
+        }
+
+        return fallback;
+    }
+
+    static constexpr const char* describe(Level value) noexcept {
+        switch (value) {
+        case Level::SCALAR:
+            return "scalar";
+        case Level::SSE42:
+            return "sse42";
+        case Level::AVX2:
+            return "avx2";
+        case Level::AVX512:
+            return "avx512";
+        }
+
+        return "unknown";
+    }
+
+  private:
+    static std::atomic<Level>& current() noexcept {
+        static std::atomic<Level> value(initial());
+        return value;
+    }
+
+    static Level initial() noexcept {
+        auto* name = getenv("NETADDR_CPU");
+        auto value = name ? parse(name, supported()) : supported();
+        return value < supported() ? value : supported();
+    }
+
+    static Level detect() noexcept {
+#ifdef _MSC_VER
+        int regs[4];
+        __cpuid(regs, 0);
+        if (regs[0] < 7) {
+            return Level::SSE42;
+        }
+
+        __cpuid(regs, 1);
+        bool osxsave = regs[2] & (1 << 27);
+        bool avx = regs[2] & (1 << 28);
+        if (!osxsave || !avx) {
+            return Level::SSE42;
+        }
+
+        // the OS saves YMM and, for AVX-512, opmask and ZMM registers
+        auto xcr0 = _xgetbv(0);
+        __cpuidex(regs, 7, 0);
+        bool avx2 = (regs[1] & (1 << 5)) && (xcr0 & 0x06) == 0x06;
+        bool avx512 = (regs[1] & (1 << 16)) && (regs[1] & (1 << 30)) &&
+                      (regs[1] & (1 << 31)) && (xcr0 & 0xE6) == 0xE6;
+#else
+        __builtin_cpu_init();
+        bool avx2 = __builtin_cpu_supports("avx2");
+        bool avx512 = __builtin_cpu_supports("avx512f") &&
+                      __builtin_cpu_supports("avx512bw") &&
+                      __builtin_cpu_supports("avx512vl");
+#endif
+
+        if (avx512 && avx2) {
+            return Level::AVX512;
+        }
+
+        return avx2 ? Level::AVX2 : Level::SSE42;
+    }
+};
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,193 @@
+#pragma once
+#ifndef NETADDR_FORMATTER_H_
+#define NETADDR_FORMATTER_H_
+
+#include <string>
+
+#include <netaddr/raw.h>
+
+namespace netaddr {
+
+// Text of addresses without allocations: dotted quad for IPv4 and RFC 5952
+// for IPv6. Output is not null-terminated, every function returns the end of
+// what it wrote. Writes are wide, so an output buffer must have BufferSize
+// bytes of room whatever the actual length is.
+class Formatter {
+  public:
+    static constexpr std::size_t MaxLength =
+        std::char_traits<char>::length("xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxxx/128");
+    static constexpr std::size_t BufferSize = 48;
+
+    // `value` is in network order
+    static char* format4(Address4 value, char* output) noexcept {
+        auto* bytes = (const std::uint8_t*)&value;
+
+        for (std::size_t i = 0; i < SizeIPv4; ++i) {
+            output = octet(bytes[i], output);
+        }
+
+        // drop the dot after the last octet
+        return output - 1;
+    }
+
+    // Always hexadecimal, even for addresses mapped to IPv4
+    static char* format6(const Raw& value, char* output) noexcept {
+        auto v = _mm_loadu_si128((const __m128i*)&value.data);
+
+        // nibbles of every byte in text order, then their digits
+        const auto digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8',
+                                          '9', 'a', 'b', 'c', 'd', 'e', 'f');
+        const auto low = _mm_set1_epi8(0x0F);
+        auto lo = _mm_and_si128(v, low);
+        auto hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+
+        alignas(16) char hex[2 * SizeIPv6];
+        auto first = _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo));
+        auto second = _mm_shuffle_epi8(digits, _mm_unpackhi_epi8(hi, lo));
+        _mm_store_si128((__m128i*)hex, first);
+        _mm_store_si128((__m128i*)(hex + sizeof(__m128i)), second);
+
+        // the longest run of zero pieces
+        auto zeros = _mm_cmpeq_epi16(v, _mm_setzero_si128());
+        auto zeroMask = _mm_movemask_epi8(_mm_packs_epi16(zeros, _mm_setzero_si128()));
+        auto run = runs.data[zeroMask];
+
+        char* out = output;
+        for (std::size_t i = 0; i < run.start; ++i) {
+            out = piece(hex, value, i, out);
+        }
+
+        if (run.length) {
+            // "::" is the colon after the previous piece or an extra one
+            *out = ':';
+            out += (run.start == 0);
+            *out++ = ':';
+        }
+
+        bool trailing = (run.length == 0);
+        for (std::size_t i = run.start + run.length; i < Pieces; ++i) {
+            out = piece(hex, value, i, out);
+            trailing = true;
+        }
+
+        return out - trailing;
+    }
+
+    // Prefix length after a slash
+    static char* formatPrefix(std::size_t prefix, char* output) noexcept {
+        *output = '/';
+        return octet((std::uint8_t)prefix, output + 1) - 1;
+    }
+
+  private:
+    static constexpr std::size_t Pieces = SizeIPv6 / sizeof(std::uint16_t);
+
+    // Decimal text of every byte value followed by a dot and its length
+    struct Octets {
+        char text[256][4];
+        std::uint8_t length[256];
+    };
+
+    // The first longest run of at least two zero pieces for every mask of zero
+    // pieces, RFC 5952 section 4.2
+    struct Run {
+        std::uint8_t start;
+        std::uint8_t length;
+    };
+
+    struct Runs {
+        Run data[256];
+    };
+
+    static constexpr Octets makeOctets() noexcept {
+        Octets table{};
+
+        for (std::size_t i = 0; i < 256; ++i) {
+            std::size_t length = 0;
+
+            if (i >= 100) {
+                table.text[i][length++] = (char)('0' + i / 100);
+            }
+            if (i >= 10) {
+                table.text[i][length++] = (char)('0' + i / 10 % 10);
+            }
+            table.text[i][length++] = (char)('0' + i % 10);
+            table.text[i][length++] = '.';
+            table.length[i] = (std::uint8_t)length;
+        }
+
+        return table;
+    }
+
+    static constexpr Runs makeRuns() noexcept {
+        Runs table{};
+
+        for (std::size_t mask = 0; mask < 256; ++mask) {
+            Run best{(std::uint8_t)Pieces, 0};
+
+            for (std::size_t start = 0; start < Pieces; ++start) {
+                std::size_t length = 0;
+                while (start + length < Pieces && (mask & (1 << (start + length)))) {
+                    ++length;
+                }
+                if (length >= 2 && length > best.length) {
+                    best = {(std::uint8_t)start, (std::uint8_t)length};
+                }
+            }
+
+            table.data[mask] = best;
+        }
+
+        return table;
+    }
+
+    static const Octets octets;
+    static const Runs runs;
+
+    static char* octet(std::uint8_t value, char* output) noexcept {
+        memcpy(output, octets.text[value], sizeof(octets.text[value]));
+        return output + octets.length[value];
+    }
+
+    // Writes piece `i` without leading zeros followed by a colon
+    static char* piece(const char* hex, const Raw& value, std::size_t i,
+                       char* output) noexcept {
+        auto word = ntohs(value.data.words[i]);
+        std::size_t skip = (word < 0x10) + (word < 0x100) + (word < 0x1000);
+
+        std::uint64_t text = 0;
+        memcpy(&text, hex + i * sizeof(std::uint32_t), sizeof(std::uint32_t));
+        text >>= skip * 8;
+        text |= (std::uint64_t)':' << ((sizeof(std::uint32_t) - skip) * 8);
+
+        memcpy(output, &text, sizeof(text));
+        return output + sizeof(std::uint32_t) - skip + 1;
+    }
+};
+
+inline constexpr Formatter::Octets Formatter::octets = Formatter::makeOctets();
+inline constexpr Formatter::Runs Formatter::runs = Formatter::makeRuns();
+
+// Addresses mapped to IPv4 are written as dotted quads
+inline char* toChars(const Raw& value, char* output) noexcept {
+    bool mapped = value.data.qwords[0] == 0 && value.data.dwords[2] == htonl(0xFFFF);
+
+    return mapped ? Formatter::format4(value.data.dwords[3], output)
+                  : Formatter::format6(value, output);
+}
+
+// Writes every address followed by `delimiter`, `output` must have room for
+// `count` times Formatter::BufferSize. Returns the end of the text.
+inline char* toChars(const Raw* input, std::size_t count, char* output,
+                     char delimiter = '\n') noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        output = toChars(input[i], output);
+        *output++ = delimiter;
+    }
+
+    return output;
+}
+
+} // namespace netaddr
+
+#endif
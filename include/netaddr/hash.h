@@ -0,0 +1,77 @@
+#pragma once
+#ifndef NETADDR_HASH_H_
+#define NETADDR_HASH_H_
+
+#include <functional>
+
+#include <netaddr/address.h>
+#include <netaddr/subnet4.h>
+
+namespace netaddr {
+
+// CRC32C based hashes, two independent CRCs over both halves of an address
+// make up 64 bits
+class Hasher {
+  public:
+    static std::uint64_t hash(const Raw& raw, std::uint64_t seed = 0) noexcept {
+        auto lo = _mm_crc32_u64(seed, raw.data.qwords[0]);
+        lo = _mm_crc32_u64(lo, raw.data.qwords[1]);
+
+        auto hi = _mm_crc32_u64(seed ^ HighSeed, raw.data.qwords[1]);
+        hi = _mm_crc32_u64(hi, raw.data.qwords[0]);
+
+        return hi << 32 | lo;
+    }
+
+    // Consistent with Subnet::operator==, which takes the address and the
+    // prefix length into account
+    static std::uint64_t hash(const Subnet& subnet) noexcept {
+        return hash(subnet.raw(), subnet.length());
+    }
+
+    static std::uint64_t hash(const Subnet4& subnet) noexcept {
+        std::uint64_t key = (std::uint64_t)ntohl(subnet.addr4().s_addr) << 8 |
+                            subnet.cidr();
+
+        return _mm_crc32_u64(HighSeed, key) << 32 | _mm_crc32_u64(0, key);
+    }
+
+  private:
+    static constexpr std::uint64_t HighSeed = 0x9E3779B97F4A7C15ULL;
+};
+
+} // namespace netaddr
+
+namespace std {
+
+template <>
+struct hash<netaddr::Raw> {
+    std::size_t operator()(const netaddr::Raw& raw) const noexcept {
+        return (std::size_t)netaddr::Hasher::hash(raw);
+    }
+};
+
+template <>
+struct hash<netaddr::Subnet> {
+    std::size_t operator()(const netaddr::Subnet& subnet) const noexcept {
+        return (std::size_t)netaddr::Hasher::hash(subnet);
+    }
+};
+
+template <>
+struct hash<netaddr::Subnet4> {
+    std::size_t operator()(const netaddr::Subnet4& subnet) const noexcept {
+        return (std::size_t)netaddr::Hasher::hash(subnet);
+    }
+};
+
+template <>
+struct hash<netaddr::Address> {
+    std::size_t operator()(const netaddr::Address& address) const noexcept {
+        return (std::size_t)netaddr::Hasher::hash(address);
+    }
+};
+
+} // namespace std
+
+#endif
@@ -0,0 +1,149 @@
+#pragma once
+#ifndef NETADDR_LOADER_H_
+#define NETADDR_LOADER_H_
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+#include <netaddr/mappedfile.h>
+#include <netaddr/parallel.h>
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// Parses prefix lists with one subnet per line on several threads. Text is
+// split into chunks at line ends, chunks are parsed without exceptions and
+// their results are joined in the order of the input. Blank lines and lines
+// starting with '#' are skipped, lines may end with "\r\n".
+class SubnetLoader {
+  public:
+    struct LineError {
+        // 1-based number of the line in the input
+        std::size_t line;
+        Error error;
+
+        bool operator==(const LineError& other) const noexcept {
+            return line == other.line && error == other.error;
+        }
+    };
+
+    struct Loaded {
+        std::vector<Subnet> subnets;
+        std::vector<LineError> errors;
+    };
+
+    // `threads` is the number of hardware threads if 0
+    static Loaded loadText(std::string_view text, std::size_t threads = 0) {
+        threads = parallel::threads(threads, text.size(), MinChunkSize);
+
+        std::vector<Chunk> chunks(threads);
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i < threads; ++i) {
+            auto end = boundary(text, text.size() / threads * (i + 1));
+            end = (i + 1 == threads) ? text.size() : std::max(end, begin);
+            chunks[i].text = text.substr(begin, end - begin);
+            begin = end;
+        }
+
+        parallel::run(threads, [&chunks](std::size_t i) { parse(chunks[i]); });
+
+        Loaded loaded;
+        std::size_t total = 0;
+        std::size_t lines = 0;
+        for (auto& chunk : chunks) {
+            if (chunk.failure) {
+                std::rethrow_exception(chunk.failure);
+            }
+
+            chunk.offset = total;
+            total += chunk.subnets.size();
+
+            for (auto error : chunk.errors) {
+                error.line += lines;
+                loaded.errors.push_back(error);
+            }
+            lines += chunk.lines;
+        }
+
+        loaded.subnets.resize(total);
+        parallel::run(threads, [&chunks, &loaded](std::size_t i) {
+            std::copy(chunks[i].subnets.begin(), chunks[i].subnets.end(),
+                      loaded.subnets.begin() + chunks[i].offset);
+        });
+
+        return loaded;
+    }
+
+    // Maps the file into memory, throws std::runtime_error if it can't
+    static Loaded loadFile(const std::string& path, std::size_t threads = 0) {
+        MappedFile file(path);
+        return loadText(file.view(), threads);
+    }
+
+  private:
+    // smaller inputs aren't worth a thread
+    static constexpr std::size_t MinChunkSize = 64 * 1024;
+
+    struct Chunk {
+        std::string_view text;
+        std::vector<Subnet> subnets;
+        std::vector<LineError> errors;
+        // lines are numbered from 1 in every chunk
+        std::size_t lines = 0;
+        // of the first subnet in the joined result
+        std::size_t offset = 0;
+        std::exception_ptr failure;
+    };
+
+    // The start of the line containing `pos - 1` or the end of `text`
+    static std::size_t boundary(std::string_view text, std::size_t pos) noexcept {
+        if (pos == 0) {
+            return 0;
+        }
+
+        auto it = text.find('\n', pos - 1);
+        return it == text.npos ? text.size() : it + 1;
+    }
+
+    static void parse(Chunk& chunk) noexcept {
+        try {
+            auto text = chunk.text;
+            std::size_t line = 0;
+
+            for (std::size_t pos = 0; pos < text.size();) {
+                auto end = std::min(text.find('\n', pos), text.size());
+                auto item = text.substr(pos, end - pos);
+                pos = end + 1;
+                ++line;
+
+                if (!item.empty() && item.back() == '\r') {
+                    item.remove_suffix(1);
+                }
+                if (item.empty() || item.front() == '#') {
+                    continue;
+                }
+
+                auto result = Subnet::tryParse(item);
+                if (result) {
+                    chunk.subnets.push_back(result.value());
+                } else {
+                    chunk.errors.push_back({line, result.error()});
+                }
+            }
+
+            chunk.lines = line;
+        } catch (...) {
+            chunk.failure = std::current_exception();
+        }
+    }
+};
+
+inline SubnetLoader::Loaded loadSubnets(const std::string& path,
+                                        std::size_t threads = 0) {
+    return SubnetLoader::loadFile(path, threads);
+}
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef NETADDR_LPM4_H_
+#define NETADDR_LPM4_H_
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// Longest prefix match table for IPv4 in DIR-24-8 layout. The upper 24 bits of
+// an address index a flat table of 2^24 entries. Entries covered by subnets
+// longer than /24 point to a group of 256 entries indexed by the lower 8 bits,
+// so a lookup takes at most two memory accesses.
+template <typename Value>
+class Lpm4 {
+  public:
+    using Route = std::pair<Subnet, Value>;
+
+    Lpm4() : tbl24(Tbl24Size, 0) {}
+
+    // Routes must be IPv4 or mapped IPv6 subnets. If the same subnet comes more
+    // than once, the last one wins.
+    Lpm4(const std::vector<Route>& routes) : Lpm4() {
+        std::vector<const Route*> sorted;
+        sorted.reserve(routes.size());
+
+        for (const auto& route : routes) {
+            if (!route.first.mapped()) {
+                throw std::invalid_argument("only IPv4 subnets can be added to Lpm4");
+            }
+            sorted.push_back(&route);
+        }
+
+        // shorter prefixes go first and get overwritten by more specific ones
+        std::stable_sort(sorted.begin(), sorted.end(), [](auto* lhs, auto* rhs) {
+            return length(lhs->first) < length(rhs->first);
+        });
+
+        values.reserve(sorted.size());
+        for (auto* route : sorted) {
+            values.push_back(route->second);
+            insert(route->first, (Entry)values.size());
+        }
+    }
+
+    ~Lpm4() = default;
+
+    // `address` is in network byte order as in struct in_addr
+    const Value* lookup(Address4 address) const noexcept {
+        auto host = ntohl(address);
+        auto entry = tbl24[host >> Tbl8Bits];
+
+        if (entry & Extended) {
+            entry = tbl8[group(entry) + (host & Tbl8Mask)];
+        }
+
+        return entry ? &values[entry - 1] : nullptr;
+    }
+
+    const Value* lookup(const Subnet& address) const noexcept {
+        return address.mapped() ? lookup(address.addr4().s_addr) : nullptr;
+    }
+
+    // Looks up `count` addresses at once, prefetching first level entries a few
+    // addresses ahead, so that cache misses overlap even when the caller's loop
+    // can't be reordered
+    void lookup(const Address4* addresses, std::size_t count,
+                const Value** results) const noexcept {
+        constexpr std::size_t Ahead = 16;
+
+        for (std::size_t i = 0; i < std::min(Ahead, count); ++i) {
+            prefetch(addresses[i]);
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i + Ahead < count) {
+                prefetch(addresses[i + Ahead]);
+            }
+            results[i] = lookup(addresses[i]);
+        }
+    }
+
+    std::size_t size() const noexcept { return values.size(); }
+
+  private:
+    // zero is "no route", otherwise either an index of the value plus one or,
+    // with the Extended bit, an index of a group in tbl8
+    using Entry = std::uint32_t;
+
+    static constexpr Entry Extended = 0x80000000;
+    static constexpr std::size_t Tbl8Bits = 8;
+    static constexpr std::size_t Tbl8Size = 1 << Tbl8Bits;
+    static constexpr std::uint32_t Tbl8Mask = Tbl8Size - 1;
+    static constexpr std::size_t Tbl24Size = 1 << (32 - Tbl8Bits);
+    static constexpr std::size_t MaxPrefix = 32;
+    static constexpr std::size_t MappedOffset = 96;
+
+    static std::size_t length(const Subnet& subnet) noexcept {
+        return subnet.v4() ? subnet.cidr() : subnet.cidr() - MappedOffset;
+    }
+
+    void prefetch(Address4 address) const noexcept {
+        auto* entry = &tbl24[ntohl(address) >> Tbl8Bits];
+        _mm_prefetch((const char*)entry, _MM_HINT_T0);
+    }
+
+    static std::size_t group(Entry entry) noexcept {
+        return (std::size_t)(entry & ~Extended) << Tbl8Bits;
+    }
+
+    void insert(const Subnet& subnet, Entry entry) {
+        auto len = length(subnet);
+        auto host = ntohl(subnet.addr4().s_addr);
+
+        if (len <= MaxPrefix - Tbl8Bits) {
+            auto first = tbl24.begin() + (host >> Tbl8Bits);
+            std::fill(first, first + (1 << (MaxPrefix - Tbl8Bits - len)), entry);
+            return;
+        }
+
+        auto& slot = tbl24[host >> Tbl8Bits];
+        if (!(slot & Extended)) {
+            // the group inherits the route covering the whole /24
+            auto index = (Entry)(tbl8.size() / Tbl8Size);
+            tbl8.resize(tbl8.size() + Tbl8Size, slot);
+            slot = index | Extended;
+        }
+
+        auto first = tbl8.begin() + group(slot) + (host & Tbl8Mask);
+        std::fill(first, first + (1 << (MaxPrefix - len)), entry);
+    }
+
+    std::vector<Entry> tbl24;
+    std::vector<Entry> tbl8;
+    std::vector<Value> values;
+};
+
+} // namespace netaddr
+
+#endif
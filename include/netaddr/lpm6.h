@@ -0,0 +1,267 @@
+#pragma once
+#ifndef NETADDR_LPM6_H_
+#define NETADDR_LPM6_H_
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// Longest prefix match table over 128-bit addresses, a multibit trie
+// compressed the way Poptrie does it. Every node covers 6 bits of an address
+// with two 64-bit maps: `vector` marks slots which continue with a child node
+// and `leafvec` marks slots where a run of equal leaves starts. Children and
+// leaves of a node are stored contiguously, so the position of a slot's child
+// or leaf is just a popcount of the map below it. The first 16 bits are
+// resolved with a plain array pointing either to a leaf or to a node.
+//
+// IPv4 subnets are keyed by their mapped IPv6 form.
+template <typename Value>
+class Lpm6 {
+  public:
+    using Route = std::pair<Subnet, Value>;
+
+    Lpm6() : direct(DirectSize, DirectLeaf) {}
+
+    // If the same subnet comes more than once, the last one wins
+    Lpm6(const std::vector<Route>& routes) {
+        std::vector<Prefix> prefixes;
+        prefixes.reserve(routes.size());
+
+        for (const auto& route : routes) {
+            Raw addr(route.first.addr6());
+            auto len = route.first.v4() ? route.first.cidr() + MappedOffset
+                                        : route.first.cidr();
+
+            values.push_back(route.second);
+            prefixes.push_back({key(addr), (std::uint32_t)len, (Leaf)values.size()});
+        }
+
+        // more specific subnets follow the ones covering them, equal subnets
+        // keep the input order
+        std::stable_sort(prefixes.begin(), prefixes.end(), [](auto& lhs, auto& rhs) {
+            return std::tie(lhs.key, lhs.length) < std::tie(rhs.key, rhs.length);
+        });
+
+        build(prefixes.data(), prefixes.data() + prefixes.size());
+
+        nodes.shrink_to_fit();
+        leaves.shrink_to_fit();
+    }
+
+    ~Lpm6() = default;
+
+    const Value* lookup(const Raw& address) const noexcept {
+        auto k = key(address);
+        auto entry = direct[k.hi >> (64 - DirectBits)];
+        Leaf leaf = entry & ~DirectLeaf;
+
+        if (!(entry & DirectLeaf)) {
+            const Node* node = &nodes[entry];
+            std::size_t offset = DirectBits;
+            auto slot = chunk(k, offset);
+
+            while (node->vector & (1ULL << slot)) {
+                node = &nodes[node->base1 + rank(node->vector, slot)];
+                offset += Stride;
+                slot = chunk(k, offset);
+            }
+
+            leaf = leaves[node->base0 + rank(node->leafvec, slot)];
+        }
+
+        return leaf ? &values[leaf - 1] : nullptr;
+    }
+
+    const Value* lookup(const Subnet& address) const noexcept {
+        return lookup(Raw(address.addr6()));
+    }
+
+    std::size_t size() const noexcept { return values.size(); }
+
+    // bytes taken by the trie itself, values aside
+    std::size_t memory() const noexcept {
+        return direct.size() * sizeof(Leaf) + nodes.size() * sizeof(Node) +
+               leaves.size() * sizeof(Leaf);
+    }
+
+  private:
+    // zero is "no route", otherwise an index of the value plus one
+    using Leaf = std::uint32_t;
+
+    struct Key {
+        std::uint64_t hi;
+        std::uint64_t lo;
+
+        bool operator<(const Key& other) const noexcept {
+            return std::tie(hi, lo) < std::tie(other.hi, other.lo);
+        }
+    };
+
+    struct Prefix {
+        Key key;
+        std::uint32_t length;
+        Leaf leaf;
+    };
+
+    struct Node {
+        std::uint64_t vector = 0;
+        std::uint64_t leafvec = 0;
+        std::uint32_t base0 = 0;
+        std::uint32_t base1 = 0;
+    };
+
+    static constexpr std::size_t Stride = 6;
+    static constexpr std::size_t Slots = 1 << Stride;
+    static constexpr std::size_t DirectBits = 16;
+    static constexpr std::size_t DirectSize = 1 << DirectBits;
+    // marks direct entries holding a leaf rather than a node index
+    static constexpr Leaf DirectLeaf = 0x80000000;
+    static constexpr std::size_t MappedOffset = 96;
+
+    // host order halves, so that shifts walk bits in network order
+    static Key key(const Raw& raw) noexcept { return {raw.qword(0), raw.qword(1)}; }
+
+    // `Bits` bits of `k` starting from bit `offset`, padded with zeros past
+    // the end of the address
+    template <std::size_t Bits = Stride>
+    static std::size_t chunk(const Key& k, std::size_t offset) noexcept {
+        std::uint64_t top = k.hi;
+
+        if (offset >= 64) {
+            top = k.lo << (offset - 64);
+        } else if (offset > 0) {
+            top = (k.hi << offset) | (k.lo >> (64 - offset));
+        }
+
+        return top >> (64 - Bits);
+    }
+
+    // number of set bits of `map` up to and including `slot` minus one, the
+    // shift wraps to zero for the last slot and the mask becomes all ones
+    static std::size_t rank(std::uint64_t map, std::size_t slot) noexcept {
+        return (std::size_t)_mm_popcnt_u64(map & ((2ULL << slot) - 1)) - 1;
+    }
+
+    // Sets `slots` covering `Bits` bits at depth `offset` to leaves of prefixes
+    // from [first, last) ending within them, longer prefixes override shorter
+    template <std::size_t Bits>
+    static void fill(const Prefix* first, const Prefix* last, std::size_t offset,
+                     Leaf* slots) {
+        std::vector<const Prefix*> ending;
+        for (auto* it = first; it != last; ++it) {
+            if (it->length <= offset + Bits) {
+                ending.push_back(it);
+            }
+        }
+        std::stable_sort(ending.begin(), ending.end(), [](auto* lhs, auto* rhs) {
+            return lhs->length < rhs->length;
+        });
+
+        for (auto* prefix : ending) {
+            auto from = chunk<Bits>(prefix->key, offset);
+            auto count = std::size_t(1) << (offset + Bits - prefix->length);
+            std::fill(slots + from, slots + from + count, prefix->leaf);
+        }
+    }
+
+    // Builds the direct array from all prefixes sorted by key, every slot with
+    // longer prefixes gets a node of its own
+    void build(const Prefix* first, const Prefix* last) {
+        std::vector<Leaf> slots(DirectSize, 0);
+        fill<DirectBits>(first, last, 0, slots.data());
+
+        direct.resize(DirectSize);
+        for (std::size_t slot = 0; slot < DirectSize; ++slot) {
+            direct[slot] = DirectLeaf | slots[slot];
+        }
+
+        for (auto* it = first; it != last;) {
+            if (it->length <= DirectBits) {
+                ++it;
+                continue;
+            }
+
+            auto slot = chunk<DirectBits>(it->key, 0);
+            auto* end = it;
+            while (end != last && chunk<DirectBits>(end->key, 0) == slot) {
+                ++end;
+            }
+
+            auto index = nodes.size();
+            direct[slot] = (Leaf)index;
+            nodes.emplace_back();
+            build(it, end, index, DirectBits, slots[slot]);
+            it = end;
+        }
+    }
+
+    // Fills node `index` at depth `offset` from prefixes in [first, last), all of
+    // them are inside of the node and longer than `offset`. Slots not covered by
+    // them get `inherited`.
+    void build(const Prefix* first, const Prefix* last, std::size_t index,
+               std::size_t offset, Leaf inherited) {
+        Leaf slots[Slots];
+        std::fill(std::begin(slots), std::end(slots), inherited);
+        fill<Stride>(first, last, offset, slots);
+
+        // slots with longer prefixes become children, every child takes a
+        // contiguous range of the sorted prefixes
+        const Prefix* begins[Slots] = {};
+        const Prefix* ends[Slots] = {};
+        std::uint64_t vector = 0;
+        for (auto* it = first; it != last; ++it) {
+            if (it->length > offset + Stride) {
+                auto slot = chunk(it->key, offset);
+                if (!(vector & (1ULL << slot))) {
+                    begins[slot] = it;
+                }
+                vector |= 1ULL << slot;
+                ends[slot] = it + 1;
+            }
+        }
+
+        std::uint64_t leafvec = 0;
+        auto base0 = (std::uint32_t)leaves.size();
+        bool started = false;
+        for (std::size_t slot = 0; slot < Slots; ++slot) {
+            if (vector & (1ULL << slot)) {
+                continue;
+            }
+            if (!started || leaves.back() != slots[slot]) {
+                leafvec |= 1ULL << slot;
+                leaves.push_back(slots[slot]);
+                started = true;
+            }
+        }
+
+        auto base1 = (std::uint32_t)nodes.size();
+        nodes.resize(nodes.size() + _mm_popcnt_u64(vector));
+
+        auto& node = nodes[index];
+        node.vector = vector;
+        node.leafvec = leafvec;
+        node.base0 = base0;
+        node.base1 = base1;
+
+        std::size_t child = base1;
+        for (std::size_t slot = 0; slot < Slots; ++slot) {
+            if (vector & (1ULL << slot)) {
+                build(begins[slot], ends[slot], child++, offset + Stride, slots[slot]);
+            }
+        }
+    }
+
+    std::vector<Leaf> direct;
+    std::vector<Node> nodes;
+    std::vector<Leaf> leaves;
+    std::vector<Value> values;
+};
+
+} // namespace netaddr
+
+#endif
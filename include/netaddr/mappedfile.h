@@ -0,0 +1,132 @@
+#pragma once
+#ifndef NETADDR_MAPPEDFILE_H_
+#define NETADDR_MAPPEDFILE_H_
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace netaddr {
+
+// Read-only memory mapping of a whole file. Empty files have no mapping and
+// no data.
+class MappedFile {
+  public:
+    // Throws std::runtime_error if the file can't be opened or mapped
+    explicit MappedFile(const std::string& path) {
+#ifdef WIN32
+        auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("can't open " + path);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("can't map " + path);
+        }
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            throw std::runtime_error("can't map " + path);
+        }
+
+        auto* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) {
+            throw std::runtime_error("can't map " + path);
+        }
+
+        base = (const char*)view;
+        length = (std::size_t)fileSize.QuadPart;
+#else
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("can't open " + path);
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("can't map " + path);
+        }
+
+        void* view = nullptr;
+        auto size = (std::size_t)info.st_size;
+        if (size) {
+            view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (view == MAP_FAILED) {
+            throw std::runtime_error("can't map " + path);
+        }
+
+        base = (const char*)view;
+        length = size;
+#endif
+    }
+
+    MappedFile(MappedFile&& other) noexcept : base(other.base), length(other.length) {
+        other.base = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            base = other.base;
+            length = other.length;
+            other.base = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { unmap(); }
+
+    const char* data() const noexcept { return base; }
+
+    std::size_t size() const noexcept { return length; }
+
+    std::string_view view() const noexcept { return {base, length}; }
+
+  private:
+    void unmap() noexcept {
+        if (base) {
+#ifdef WIN32
+            UnmapViewOfFile(base);
+#else
+            munmap((void*)base, length);
+#endif
+        }
+
+        base = nullptr;
+        length = 0;
+    }
+
+    const char* base = nullptr;
+    std::size_t length = 0;
+};
+
+} // namespace netaddr
+
+#endif
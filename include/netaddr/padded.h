@@ -0,0 +1,28 @@
+#pragma once
+#ifndef NETADDR_PADDED_H_
+#define NETADDR_PADDED_H_
+
+#include <cstddef>
+#include <string_view>
+
+namespace netaddr {
+
+// Text followed by at least Padding readable bytes of any content, such as a
+// token in a large receive buffer. Parsers given one load 16 bytes straight
+// from the text and mask off the tail in registers, without copying the text
+// to the stack or taking it apart in smaller loads. The caller vouches for the
+// padding, reading it is undefined behavior otherwise.
+class PaddedStringView : public std::string_view {
+  public:
+    static constexpr std::size_t Padding = 16;
+
+    constexpr explicit PaddedStringView(std::string_view text) noexcept
+        : std::string_view(text) {}
+
+    constexpr PaddedStringView(const char* data, std::size_t size) noexcept
+        : std::string_view(data, size) {}
+};
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef NETADDR_PARALLEL_H_
+#define NETADDR_PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace netaddr {
+
+namespace parallel {
+
+// Threads to split `size` units of work into: `requested`, or every hardware
+// thread if 0, but no more than one per `minChunk` units and at least one
+inline std::size_t threads(std::size_t requested, std::size_t size,
+                           std::size_t minChunk) noexcept {
+    if (!requested) {
+        requested = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    return std::max<std::size_t>(1, std::min(requested, size / minChunk));
+}
+
+// Runs `task(i)` for every i below `count`, the first one on this thread. Tasks
+// on other threads must not throw. If a thread can't be started or the first
+// task throws, the started threads are joined before the exception propagates.
+template <typename Task>
+void run(std::size_t count, Task task) {
+    if (!count) {
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    auto join = [&workers]() {
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    try {
+        workers.reserve(count - 1);
+        for (std::size_t i = 1; i < count; ++i) {
+            workers.emplace_back(task, i);
+        }
+        task(0);
+    } catch (...) {
+        join();
+        throw;
+    }
+
+    join();
+}
+
+} // namespace parallel
+
+} // namespace netaddr
+
+#endif
@@ -4,14 +4,22 @@
 
 #include <string>
 
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include <netaddr/cpu.h>
 #include <netaddr/raw.h>
+#include <netaddr/simd.h>
 
 namespace netaddr {
 
 class Parser4 {
   public:
+    static constexpr std::size_t MaxInputLength =
+        std::char_traits<char>::length("xxx.xxx.xxx.xxx");
+
     static bool parse(std::string_view input, Raw& output) noexcept {
-        constexpr auto MaxInputLength = std::char_traits<char>::length("xxx.xxx.xxx.xxx");
         auto sz = input.size();
 
         if (sz > MaxInputLength) {
@@ -21,8 +29,226 @@ class Parser4 {
         char buf[MaxInputLength + 1] = {0};
         memcpy(buf, input.data(), sz);
 
-        auto* src = (const __m128i*)buf;
-        __m128i v = _mm_loadu_si128(src);
+        Address4 value;
+        __m128i v = _mm_loadu_si128((const __m128i*)buf);
+        if (!decode(v, sz, value)) {
+            return false;
+        }
+
+        output.set(value);
+
+        return true;
+    }
+
+    // Same as above for padded input, see PaddedStringView
+    static bool parse(PaddedStringView input, Raw& output) noexcept {
+        Address4 value;
+        if (input.size() > MaxInputLength ||
+            !decode(simd::load(input, 0), input.size(), value)) {
+            return false;
+        }
+
+        output.set(value);
+
+        return true;
+    }
+
+    // Parses "a.b.c.d" or "a.b.c.d/nn" in one pass. On success `output` is the
+    // address masked by the prefix and `mask` is the netmask, both mapped to IPv6
+    // the same way as by Raw::set(), so the mask has 96 leading ones.
+    static bool parseCidr(std::string_view input, Raw& output, Raw& mask,
+                          std::size_t& prefix) noexcept {
+        return cidr(input, output, mask, prefix);
+    }
+
+    // Same as above with the address and the netmask in network order
+    static bool parseCidr(std::string_view input, Address4& output, Address4& mask,
+                          std::size_t& prefix) noexcept {
+        return cidr(input, output, mask, prefix);
+    }
+
+    // Same as above for padded input, see PaddedStringView
+    static bool parseCidr(PaddedStringView input, Raw& output, Raw& mask,
+                          std::size_t& prefix) noexcept {
+        return cidr(input, output, mask, prefix);
+    }
+
+    static bool parseCidr(PaddedStringView input, Address4& output, Address4& mask,
+                          std::size_t& prefix) noexcept {
+        return cidr(input, output, mask, prefix);
+    }
+
+    // Parses `count` addresses from `input` into `output`. Bit `i % 64` of
+    // `okBitmap[i / 64]` is set if and only if `input[i]` is a valid address, so
+    // `okBitmap` must hold at least (count + 63) / 64 words. Unlike parse(), the
+    // content of `output[i]` is unspecified for malformed input. Addresses are
+    // parsed one, two or four at a time depending on Cpu::level().
+    // Returns the number of successfully parsed addresses.
+    static std::size_t parseBatch(const std::string_view* input, std::size_t count,
+                                  Raw* output, std::uint64_t* okBitmap) noexcept {
+        for (std::size_t w = 0; w < (count + 63) / 64; ++w) {
+            okBitmap[w] = 0;
+        }
+
+        switch (Cpu::level()) {
+        case Cpu::Level::SCALAR:
+            return batchScalar(input, count, output, okBitmap);
+        case Cpu::Level::SSE42:
+            return batch(input, 0, count, output, okBitmap);
+        case Cpu::Level::AVX2:
+            return batchAvx2(input, count, output, okBitmap);
+        case Cpu::Level::AVX512:
+            return batchAvx512(input, count, output, okBitmap);
+        }
+
+        return 0;
+    }
+
+    // Same as parse() without SIMD, the reference for other kernels and the
+    // fallback of Cpu::Level::SCALAR
+    static bool parseScalar(std::string_view input, Raw& output) noexcept {
+        Array<std::uint8_t> bytes{};
+        if (!parseConst(input, bytes)) {
+            return false;
+        }
+
+        output = Raw(bytes);
+
+        return true;
+    }
+
+    // Same as parse() in constant expressions, `output` gets bytes of the
+    // address mapped to IPv6 as by Raw::set()
+    static constexpr bool parseConst(std::string_view input,
+                                     Array<std::uint8_t>& output) noexcept {
+        if (input.size() > MaxInputLength) {
+            return false;
+        }
+
+        std::uint8_t octets[SizeIPv4] = {};
+        std::size_t pos = 0;
+
+        for (std::size_t i = 0; i < SizeIPv4; ++i) {
+            if (i && (pos >= input.size() || input[pos++] != '.')) {
+                return false;
+            }
+
+            unsigned value = 0;
+            std::size_t digits = 0;
+            for (; pos < input.size() && digits < 4; ++pos, ++digits) {
+                unsigned digit = (unsigned char)input[pos] - '0';
+                if (digit > 9) {
+                    break;
+                }
+                value = value * 10 + digit;
+            }
+
+            // no leading zeros
+            if (digits == 0 || digits > 3 || value > 255 ||
+                (digits > 1 && input[pos - digits] == '0')) {
+                return false;
+            }
+            octets[i] = (std::uint8_t)value;
+        }
+
+        if (pos != input.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < SizeIPv6; ++i) {
+            output[i] = 0;
+        }
+        output[SizeIPv6 - SizeIPv4 - 2] = 0xFF;
+        output[SizeIPv6 - SizeIPv4 - 1] = 0xFF;
+        for (std::size_t i = 0; i < SizeIPv4; ++i) {
+            output[SizeIPv6 - SizeIPv4 + i] = octets[i];
+        }
+
+        return true;
+    }
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_span)
+    static std::size_t parseBatch(std::span<const std::string_view> input, Raw* output,
+                                  std::uint64_t* okBitmap) noexcept {
+        return parseBatch(input.data(), input.size(), output, okBitmap);
+    }
+#endif
+
+  private:
+    // parseCidr() of std::string_view or PaddedStringView `input`
+    template <typename View>
+    static bool cidr(View input, Raw& output, Raw& mask, std::size_t& prefix) noexcept {
+        Address4 addr, netmask;
+        if (!cidr(input, addr, netmask, prefix)) {
+            return false;
+        }
+
+        output.set(addr);
+        mask.set(netmask);
+        mask.data.dwords[2] = 0xFFFFFFFF;
+        mask.data.qwords[0] = 0xFFFFFFFFFFFFFFFF;
+
+        return true;
+    }
+
+    template <typename View>
+    static bool cidr(View input, Address4& output, Address4& mask,
+                     std::size_t& prefix) noexcept {
+        constexpr auto MaxCidrLength =
+            std::char_traits<char>::length("xxx.xxx.xxx.xxx/xx");
+        constexpr std::size_t MaxPrefix = 32;
+        auto sz = input.size();
+
+        if (sz > MaxCidrLength) {
+            return false;
+        }
+
+        // the slash, if any, is always within the first 16 bytes
+        __m128i v = simd::load(input, 0);
+        __m128i isSlash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+        uint32_t slashMask = (uint32_t)_mm_movemask_epi8(isSlash);
+
+        std::size_t length = sz;
+        std::size_t value = MaxPrefix;
+        if (slashMask != 0) {
+            length = simd::lowestBit(slashMask);
+
+            auto digits = sz - length - 1;
+            if (digits == 0 || digits > 2) {
+                return false;
+            }
+
+            // the same character twice for a single digit prefix
+            unsigned hi = (unsigned char)input[length + 1] - '0';
+            unsigned lo = (unsigned char)input[sz - 1] - '0';
+            if (hi > 9 || lo > 9) {
+                return false;
+            }
+
+            value = (digits == 2) ? (hi * 10 + lo) : lo;
+            if (value > MaxPrefix) {
+                return false;
+            }
+
+            v = simd::keep(v, length);
+        } else if (sz > MaxInputLength) {
+            return false;
+        }
+
+        Address4 addr;
+        if (!decode(v, length, addr)) {
+            return false;
+        }
+
+        mask = htonl(value ? (0xFFFFFFFF << (MaxPrefix - value)) : 0);
+        output = addr & mask;
+        prefix = value;
+
+        return true;
+    }
+
+    // Parses the first `size` bytes of `v`, the rest of them must be zeros
+    static bool decode(__m128i v, std::size_t size, Address4& value) noexcept {
         __m128i isDot = _mm_cmpeq_epi8(v, _mm_set1_epi8('.'));
         uint32_t dotMask = (uint32_t)_mm_movemask_epi8(isDot);
 
@@ -33,20 +259,12 @@ class Parser4 {
         uint32_t nonDigitMask = (uint32_t)_mm_movemask_epi8(v);
         v = _mm_subs_epi8(v, saturationDistance);
 
-        uint32_t badMask = dotMask ^ nonDigitMask;
-        uint32_t clipMask = badMask ^ (badMask - 1);
-        uint32_t partitionMask = nonDigitMask & clipMask;
-
-        const uint32_t length = (uint32_t)_mm_popcnt_u32(clipMask) - 1;
-
-        uint32_t hashKey = (partitionMask * 0x00CF7800) >> 24;
-        uint8_t hashId = patternsId[hashKey];
-        if (hashId >= PatternsTableHeight) {
+        uint32_t length = 0;
+        const uint8_t* const patternPtr = lookup(dotMask, nonDigitMask, length);
+        if (patternPtr == nullptr) {
             return false;
         }
 
-        const std::uint8_t(&pattern)[PatternsTableWidth] = patterns[hashId];
-        const uint8_t* const patternPtr = &pattern[0];
         __m128i shuf = _mm_loadu_si128((const __m128i*)patternPtr);
         v = _mm_shuffle_epi8(v, shuf);
 
@@ -66,16 +284,227 @@ class Parser4 {
         checkMask &= 0x0000AA00; // the only lanes wanted
 
         // pack and we are done!
-        auto value = (Address4)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
-        output.set(value);
+        value = (Address4)_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc));
 
         bool rc = ((length + checkMask - patternPtr[6]) == 1);
-        rc &= (length == input.size());
+        rc &= (length == size);
+
+        return rc;
+    }
+
+    // Maps the dot and non-digit masks of a single 16 byte lane to its shuffle
+    // pattern, returns nullptr if the input can't be a dotted quad at all
+    static const uint8_t* lookup(uint32_t dotMask, uint32_t nonDigitMask,
+                                 uint32_t& length) noexcept {
+        uint32_t badMask = dotMask ^ nonDigitMask;
+        uint32_t clipMask = badMask ^ (badMask - 1);
+        uint32_t partitionMask = nonDigitMask & clipMask;
+
+        length = (uint32_t)_mm_popcnt_u32(clipMask) - 1;
+
+        uint32_t hashKey = (partitionMask * 0x00CF7800) >> 24;
+        uint8_t hashId = patternsId[hashKey];
+        if (hashId >= PatternsTableHeight) {
+            return nullptr;
+        }
+
+        return &patterns[hashId][0];
+    }
+
+    // Parses input[from, count) one by one, returns the number of valid ones
+    static std::size_t batch(const std::string_view* input, std::size_t from,
+                             std::size_t count, Raw* output,
+                             std::uint64_t* okBitmap) noexcept {
+        std::size_t total = 0;
+
+        for (std::size_t i = from; i < count; ++i) {
+            bool ok = parse(input[i], output[i]);
+            okBitmap[i / 64] |= (std::uint64_t)ok << (i % 64);
+            total += ok;
+        }
+
+        return total;
+    }
+
+    static std::size_t batchScalar(const std::string_view* input, std::size_t count,
+                                   Raw* output, std::uint64_t* okBitmap) noexcept {
+        std::size_t total = 0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            bool ok = parseScalar(input[i], output[i]);
+            okBitmap[i / 64] |= (std::uint64_t)ok << (i % 64);
+            total += ok;
+        }
+
+        return total;
+    }
+
+    NETADDR_TARGET_AVX2
+    static std::size_t batchAvx2(const std::string_view* input, std::size_t count,
+                                 Raw* output, std::uint64_t* okBitmap) noexcept {
+        std::size_t total = 0;
+        std::size_t i = 0;
+
+        for (; i + 2 <= count; i += 2) {
+            auto ok = parse2(&input[i], &output[i]);
+            okBitmap[i / 64] |= (std::uint64_t)ok << (i % 64);
+            total += (std::size_t)_mm_popcnt_u32(ok);
+        }
+
+        return total + batch(input, i, count, output, okBitmap);
+    }
+
+    NETADDR_TARGET_AVX512
+    static std::size_t batchAvx512(const std::string_view* input, std::size_t count,
+                                   Raw* output, std::uint64_t* okBitmap) noexcept {
+        std::size_t total = 0;
+        std::size_t i = 0;
+
+        // groups of four never straddle bitmap words
+        for (; i + 4 <= count; i += 4) {
+            auto ok = parse4(&input[i], &output[i]);
+            okBitmap[i / 64] |= (std::uint64_t)ok << (i % 64);
+            total += (std::size_t)_mm_popcnt_u32(ok);
+        }
+
+        return total + batch(input, i, count, output, okBitmap);
+    }
+
+    // Same algorithm as parse() for two addresses at once, one per 128-bit lane.
+    // Every instruction below is either lane-local or a pure bitwise one, so the
+    // lanes never interact. Returns the validity of both addresses as bits 0 and 1.
+    NETADDR_TARGET_AVX2
+    static unsigned parse2(const std::string_view* input, Raw* output) noexcept {
+        alignas(32) char buf[2][MaxInputLength + 1] = {{0}};
+
+        auto sz0 = input[0].size();
+        auto sz1 = input[1].size();
+        bool fits0 = (sz0 <= MaxInputLength);
+        bool fits1 = (sz1 <= MaxInputLength);
+
+        memcpy(buf[0], input[0].data(), fits0 ? sz0 : 0);
+        memcpy(buf[1], input[1].data(), fits1 ? sz1 : 0);
+
+        __m256i v = _mm256_load_si256((const __m256i*)buf);
+        __m256i isDot = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'));
+        uint32_t dotMask = (uint32_t)_mm256_movemask_epi8(isDot);
+
+        const __m256i saturationDistance = _mm256_set1_epi8(0x7F - 9);
+        v = _mm256_xor_si256(v, _mm256_set1_epi8('0'));
+        v = _mm256_adds_epu8(v, saturationDistance);
+        uint32_t nonDigitMask = (uint32_t)_mm256_movemask_epi8(v);
+        v = _mm256_subs_epi8(v, saturationDistance);
+
+        uint32_t length0 = 0, length1 = 0;
+        const uint8_t* pattern0 =
+            lookup(dotMask & 0xFFFF, nonDigitMask & 0xFFFF, length0);
+        const uint8_t* pattern1 = lookup(dotMask >> 16, nonDigitMask >> 16, length1);
+        fits0 &= (pattern0 != nullptr);
+        fits1 &= (pattern1 != nullptr);
+        pattern0 = fits0 ? pattern0 : &patterns[0][0];
+        pattern1 = fits1 ? pattern1 : &patterns[0][0];
+
+        __m256i shuf = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)pattern0)),
+            _mm_loadu_si128((const __m128i*)pattern1), 1);
+        v = _mm256_shuffle_epi8(v, shuf);
+
+        const __m256i mulWeights =
+            _mm256_set_epi8(0, 100, 0, 100, 0, 100, 0, 100, 10, 1, 10, 1, 10, 1, 10, 1, 0,
+                            100, 0, 100, 0, 100, 0, 100, 10, 1, 10, 1, 10, 1, 10, 1);
+        __m256i acc = _mm256_maddubs_epi16(mulWeights, v);
+        __m256i swapped = _mm256_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2));
+        acc = _mm256_adds_epu16(acc, swapped);
+
+        __m256i checkLZ =
+            _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_setzero_si256(), v), shuf);
+        __m256i checkOF = _mm256_adds_epu16(_mm256_set1_epi16(0x7F00), acc);
+        __m256i checks = _mm256_or_si256(checkLZ, checkOF);
+        uint32_t checkMask = (uint32_t)_mm256_movemask_epi8(checks);
+        uint32_t checkMask0 = checkMask & 0x0000AA00;
+        uint32_t checkMask1 = (checkMask >> 16) & 0x0000AA00;
+
+        __m256i packed = _mm256_packus_epi16(acc, acc);
+        output[0].set((Address4)_mm256_extract_epi32(packed, 0));
+        output[1].set((Address4)_mm256_extract_epi32(packed, 4));
+
+        unsigned rc0 = fits0 && ((length0 + checkMask0 - pattern0[6]) == 1) &&
+                       (length0 == sz0);
+        unsigned rc1 = fits1 && ((length1 + checkMask1 - pattern1[6]) == 1) &&
+                       (length1 == sz1);
+
+        return rc0 | (rc1 << 1);
+    }
+
+    // parse2() for four addresses with AVX-512BW, masks of lanes come straight
+    // out of comparisons. Returns the validity of the addresses as bits 0 to 3.
+    NETADDR_TARGET_AVX512
+    static unsigned parse4(const std::string_view* input, Raw* output) noexcept {
+        constexpr std::size_t Lanes = 4;
+        constexpr std::size_t LaneSize = sizeof(__m128i);
+        alignas(64) char buf[Lanes][LaneSize] = {{0}};
+        alignas(64) std::uint8_t shufs[Lanes][LaneSize];
+        const uint8_t* pattern[Lanes];
+        uint32_t length[Lanes];
+        bool fits[Lanes];
+
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            auto sz = input[i].size();
+            fits[i] = (sz <= MaxInputLength);
+            memcpy(buf[i], input[i].data(), fits[i] ? sz : 0);
+        }
+
+        __m512i v = _mm512_load_si512((const void*)buf);
+        std::uint64_t dotMask = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('.'));
+
+        const __m512i saturationDistance = _mm512_set1_epi8(0x7F - 9);
+        v = _mm512_xor_si512(v, _mm512_set1_epi8('0'));
+        v = _mm512_adds_epu8(v, saturationDistance);
+        std::uint64_t nonDigitMask = _mm512_movepi8_mask(v);
+        v = _mm512_subs_epi8(v, saturationDistance);
+
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            auto shift = i * LaneSize;
+            length[i] = 0;
+            pattern[i] = lookup((uint32_t)(dotMask >> shift) & 0xFFFF,
+                                (uint32_t)(nonDigitMask >> shift) & 0xFFFF, length[i]);
+            fits[i] &= (pattern[i] != nullptr);
+            pattern[i] = fits[i] ? pattern[i] : &patterns[0][0];
+            memcpy(shufs[i], pattern[i], LaneSize);
+        }
+
+        __m512i shuf = _mm512_load_si512((const void*)shufs);
+        v = _mm512_shuffle_epi8(v, shuf);
+
+        // the weights of parse2() in every lane, swapped halves of lanes
+        const __m512i mulWeights =
+            _mm512_set4_epi32(0x00640064, 0x00640064, 0x0A010A01, 0x0A010A01);
+        __m512i acc = _mm512_maddubs_epi16(mulWeights, v);
+        __m512i swapped = _mm512_alignr_epi8(acc, acc, sizeof(std::uint64_t));
+        acc = _mm512_adds_epu16(acc, swapped);
+
+        // sign bits of the checks of parse2() as masks
+        std::uint64_t checkLZ = _mm512_cmpeq_epi8_mask(_mm512_setzero_si512(), v) ^
+                                _mm512_movepi8_mask(shuf);
+        __m512i checkOF = _mm512_adds_epu16(_mm512_set1_epi16(0x7F00), acc);
+        std::uint64_t checkMask = checkLZ | _mm512_movepi8_mask(checkOF);
+
+        alignas(64) std::uint32_t packed[Lanes * LaneSize / sizeof(std::uint32_t)];
+        _mm512_store_si512((void*)packed, _mm512_packus_epi16(acc, acc));
+
+        unsigned rc = 0;
+        for (std::size_t i = 0; i < Lanes; ++i) {
+            auto laneCheck = (uint32_t)(checkMask >> (i * LaneSize)) & 0x0000AA00;
+            output[i].set((Address4)packed[i * LaneSize / sizeof(std::uint32_t)]);
+
+            bool ok = fits[i] && ((length[i] + laneCheck - pattern[i][6]) == 1) &&
+                      (length[i] == input[i].size());
+            rc |= (unsigned)ok << i;
+        }
 
         return rc;
     }
 
-  private:
     static constexpr std::size_t PatternsIdTableSize = 256;
     static constexpr std::size_t PatternsTableHeight = 81;
     static constexpr std::size_t PatternsTableWidth = 16;
@@ -2,110 +2,342 @@
 #ifndef NETADDR_PARSER6_H_
 #define NETADDR_PARSER6_H_
 
-#include <optional>
+#include <algorithm>
 #include <string>
 
-#include <assert.h>
-
+#include <netaddr/parser4.h>
 #include <netaddr/raw.h>
+#include <netaddr/simd.h>
 
 namespace netaddr {
 
 class Parser6 {
   public:
+    // the longest form ends with an IPv4 address
+    static constexpr std::size_t MaxInputLength =
+        std::char_traits<char>::length("xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxx.xxx.xxx.xxx");
+
     static bool parse(std::string_view input, Raw& output) noexcept {
-        static constexpr auto MaxPieces = sizeof(struct in6_addr) / sizeof(std::uint16_t);
-        static constexpr auto MaxPiecesSize = 4;
+        return decode(input, output);
+    }
+
+    // Same as above for padded input, see PaddedStringView
+    static bool parse(PaddedStringView input, Raw& output) noexcept {
+        return decode(input, output);
+    }
+
+    // Same as parse() in constant expressions, one piece at a time
+    static constexpr bool parseConst(std::string_view input,
+                                     Array<std::uint8_t>& output) noexcept {
+        constexpr auto npos = std::string_view::npos;
+        auto sz = input.size();
 
-        if (input.empty()) {
+        if (sz == 0 || sz > MaxInputLength) {
             return false;
         }
 
-        int pieceIndex = 0;
-        std::optional<int> compress{};
-        auto pointer = input.begin();
-        auto* piece = output.data.words.data();
+        std::uint16_t pieces[MaxPieces] = {};
+        std::size_t count = 0;
+        std::size_t gap = npos;
+        std::size_t pos = 0;
 
-        output.data.qwords.fill(0);
+        if (input.substr(0, 2) == "::") {
+            gap = 0;
+            pos = 2;
+        }
 
-        if (input[0] == ':') {
-            if (input.size() == 1 || input[1] != ':') {
-                return false;
+        while (pos < sz) {
+            // an IPv4 address makes the last two pieces
+            if (input.find(':', pos) == npos && input.find('.', pos) != npos) {
+                Array<std::uint8_t> ipv4{};
+                if (count + SuffixPieces > MaxPieces ||
+                    !Parser4::parseConst(input.substr(pos), ipv4)) {
+                    return false;
+                }
+
+                auto* bytes = &ipv4[SizeIPv6 - SizeIPv4];
+                pieces[count++] = (std::uint16_t)(bytes[0] << 8 | bytes[1]);
+                pieces[count++] = (std::uint16_t)(bytes[2] << 8 | bytes[3]);
+                break;
             }
-            pointer += 2;
-            compress = ++pieceIndex;
-        }
 
-        while (pointer != input.end()) {
-            std::uint16_t value = 0, length = 0;
+            unsigned value = 0;
+            std::size_t digits = 0;
+            for (; pos < sz && digits <= 4; ++pos, ++digits) {
+                unsigned digit = hex(input[pos]);
+                if (digit > 0xF) {
+                    break;
+                }
+                value = value << 4 | digit;
+            }
 
-            if (pieceIndex == MaxPieces) {
+            if (digits == 0 || digits > 4 || count == MaxPieces) {
                 return false;
             }
+            pieces[count++] = (std::uint16_t)value;
+
+            if (pos == sz) {
+                break;
+            }
 
-            if (*pointer == ':') {
-                if (compress.has_value()) {
+            // a colon, then either the next piece or the second colon of "::"
+            if (input[pos++] != ':' || pos == sz) {
+                return false;
+            }
+            if (input[pos] == ':') {
+                if (gap != npos) {
                     return false;
                 }
-                ++pointer;
-                compress = ++pieceIndex;
-                continue;
+                gap = count;
+                ++pos;
             }
+        }
+
+        if (gap == npos ? count != MaxPieces : count >= MaxPieces) {
+            return false;
+        }
+
+        // pieces following "::" go to the end
+        auto shift = (gap == npos) ? 0 : MaxPieces - count;
+        for (std::size_t i = 0; i < SizeIPv6; ++i) {
+            output[i] = 0;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            auto at = (i < gap) ? i : i + shift;
+            output[at * 2] = (std::uint8_t)(pieces[i] >> 8);
+            output[at * 2 + 1] = (std::uint8_t)pieces[i];
+        }
 
-            while (length < MaxPiecesSize && pointer != input.end() &&
-                   isAsciiHexDigit(*pointer)) {
-                value = static_cast<uint16_t>(value * 0x10 + hexToBinary(*pointer));
-                ++pointer;
-                length++;
+        return true;
+    }
+
+  private:
+    // parse() of std::string_view or PaddedStringView `input`
+    template <typename View>
+    static bool decode(View input, Raw& output) noexcept {
+        auto sz = input.size();
+
+        if (sz == 0 || sz > MaxInputLength) {
+            return false;
+        }
+
+        __m128i nibbles[Chunks];
+        std::uint64_t hexMask = 0, colonMask = 0, dotMask = 0;
+        for (std::size_t i = 0; i < Chunks; ++i) {
+            __m128i v = simd::load(input, i);
+            std::uint64_t hex, colon;
+
+            nibbles[i] = classify(v, hex, colon);
+            hexMask |= hex << (i * sizeof(__m128i));
+            colonMask |= colon << (i * sizeof(__m128i));
+
+            __m128i isDot = _mm_cmpeq_epi8(v, _mm_set1_epi8('.'));
+            dotMask |= (std::uint64_t)(std::uint32_t)_mm_movemask_epi8(isDot)
+                       << (i * sizeof(__m128i));
+        }
+
+        // An IPv4 address after the last colon, as in "::ffff:192.0.2.1", makes
+        // the last two pieces. The text before it is checked as usual, but
+        // only up to the colon, which stays if it's a part of "::".
+        std::size_t size = sz;
+        std::size_t suffix = 0;
+        Raw ipv4;
+        if (dotMask) {
+            if (!colonMask) {
+                return false;
             }
 
-            if ((pointer != input.end()) && (*pointer == ':')) {
-                ++pointer;
-                if (pointer == input.end()) {
-                    return false;
-                }
-            } else if (pointer != input.end()) {
+            std::size_t last = simd::highestBit(colonMask);
+            if (!Parser4::parse(View(input.substr(last + 1)), ipv4)) {
                 return false;
             }
 
-            piece[pieceIndex] = htons(value);
-            pieceIndex++;
+            size = (last > 0 && input[last - 1] == ':') ? last + 1 : last;
+            if (size == 0) {
+                return false;
+            }
+
+            hexMask &= (1ULL << size) - 1;
+            colonMask &= (1ULL << size) - 1;
+            suffix = SuffixPieces;
         }
 
-        if (compress.has_value()) {
-            int swaps = pieceIndex - *compress;
-            pieceIndex = MaxPieces - 1;
+        const std::uint64_t lengthMask = (1ULL << size) - 1;
+        const std::uint64_t doubleMask = colonMask & (colonMask >> 1);
+        const std::uint64_t starts = hexMask & ~(hexMask << 1);
+        const std::uint64_t ends = hexMask & ~(hexMask >> 1);
 
-            while (pieceIndex != 0 && swaps > 0) {
-                std::swap(piece[pieceIndex], piece[*compress + swaps - 1]);
-                pieceIndex--;
-                swaps--;
-            }
-        } else if (pieceIndex != MaxPieces) {
+        // pieces of more than 4 digits, ":::" and more than one "::"
+        std::uint64_t tooLong = hexMask & (hexMask >> 1);
+        tooLong &= (tooLong >> 2);
+        tooLong &= (hexMask >> 4);
+
+        bool rc = ((hexMask | colonMask) == lengthMask);
+        rc &= (tooLong == 0);
+        rc &= ((doubleMask & (doubleMask >> 1)) == 0);
+        rc &= (_mm_popcnt_u64(doubleMask) <= 1);
+
+        // a single colon is allowed only between pieces
+        const std::uint64_t edges = 1ULL | (1ULL << (size - 1));
+        const std::uint64_t doubleColons = doubleMask | (doubleMask << 1);
+        rc &= ((colonMask & edges & ~doubleColons) == 0);
+
+        // "::" always stands for at least one zero piece
+        const auto pieces = (std::size_t)_mm_popcnt_u64(starts);
+        rc &= doubleMask ? (pieces + suffix < MaxPieces) : (pieces + suffix == MaxPieces);
+
+        if (!rc) {
             return false;
         }
 
+        // compute shuffle indices which collect every piece right-aligned to 4
+        // nibbles, indices are biased by IndexBias to stay positive
+        std::uint32_t indices[MaxPieces] = {
+            Untouched, Untouched, Untouched, Untouched,
+            Untouched, Untouched, Untouched, Untouched,
+        };
+        std::uint64_t remainingStarts = starts, remainingEnds = ends;
+        for (std::size_t i = 0; i < pieces; ++i) {
+            auto start = simd::lowestBit(remainingStarts);
+            auto end = simd::lowestBit(remainingEnds);
+            auto length = end - start + 1;
+            auto keep = 0xFFFFFFFF << ((4 - length) * 8);
+
+            indices[i] = ((end * 0x01010101 + 0x03020100) & keep) | (Untouched & ~keep);
+
+            remainingStarts &= remainingStarts - 1;
+            remainingEnds &= remainingEnds - 1;
+        }
+
+        // gather nibbles chunk by chunk, the first 4 pieces always end before the
+        // last chunk
+        const std::size_t chunks = (size + sizeof(__m128i) - 1) / sizeof(__m128i);
+        __m128i gathered[2];
+        for (std::size_t i = 0; i < 2; ++i) {
+            auto* dwords = &indices[i * 4];
+            __m128i index = _mm_setr_epi32(dwords[0], dwords[1], dwords[2], dwords[3]);
+            gathered[i] = _mm_setzero_si128();
+
+            auto last = std::min(chunks, Chunks - 1 + i);
+            for (std::size_t chunk = 0; chunk < last; ++chunk) {
+                auto bias = (char)(IndexBias + chunk * sizeof(__m128i));
+                __m128i local = _mm_sub_epi8(index, _mm_set1_epi8(bias));
+                __m128i above = _mm_cmpgt_epi8(local, _mm_set1_epi8(15));
+                __m128i below = _mm_cmpgt_epi8(_mm_setzero_si128(), local);
+                __m128i outside = _mm_or_si128(above, below);
+                local = _mm_or_si128(local, outside);
+                gathered[i] =
+                    _mm_or_si128(gathered[i], _mm_shuffle_epi8(nibbles[chunk], local));
+            }
+        }
+
+        // every dword holds 4 nibbles of a piece, join them into network order
+        // bytes
+        const __m128i weights = _mm_set1_epi16(0x0110);
+        __m128i lo = _mm_maddubs_epi16(gathered[0], weights);
+        __m128i hi = _mm_maddubs_epi16(gathered[1], weights);
+        __m128i v = _mm_packus_epi16(lo, hi);
+
+        // the IPv4 address follows the pieces, "::" moves it to the end as well
+        if (suffix) {
+            auto shift = _mm_loadu_si128((const __m128i*)(simd::shifts - pieces * 2));
+            auto tail = _mm_cvtsi32_si128((int)ipv4.data.dwords[OffsetIPv4Dword]);
+            v = _mm_or_si128(v, _mm_shuffle_epi8(tail, shift));
+        }
+
+        // move pieces following "::" to the end
+        if (doubleMask) {
+            auto position = simd::lowestBit(doubleMask);
+            auto before = _mm_popcnt_u64(starts & ((1ULL << position) - 1));
+            auto total = pieces + suffix;
+            auto shuf = _mm_load_si128((const __m128i*)expansions.data[before][total]);
+            v = _mm_shuffle_epi8(v, shuf);
+        }
+
+        _mm_storeu_si128((__m128i*)&output.data, v);
+
         return true;
     }
 
-  private:
-    static constexpr std::uint8_t hexToBinaryTable[] = {
-        0,  1,  2,  3,  4, 5, 6, 7, 8, 9, 0, 0,  0,  0,  0,  0,  0,  10, 11,
-        12, 13, 14, 15, 0, 0, 0, 0, 0, 0, 0, 0,  0,  0,  0,  0,  0,  0,  0,
-        0,  0,  0,  0,  0, 0, 0, 0, 0, 0, 0, 10, 11, 12, 13, 14, 15,
-    };
+    static constexpr std::size_t MaxPieces =
+        sizeof(struct in6_addr) / sizeof(std::uint16_t);
+    // of an IPv4 address at the end
+    static constexpr std::size_t SuffixPieces = SizeIPv4 / sizeof(std::uint16_t);
+
+    // Value of a hex digit or more than 0xF
+    static constexpr unsigned hex(char c) noexcept {
+        if (c >= '0' && c <= '9') {
+            return (unsigned)(c - '0');
+        }
+        if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            return (unsigned)((c | 0x20) - 'a' + 10);
+        }
+        return 0x10;
+    }
+    static constexpr std::size_t Chunks = 3;
+    static constexpr std::size_t IndexBias = 3;
+    // shuffle index out of range of every chunk, so nibbles at it are zero
+    static constexpr std::uint32_t Untouched = 0x70707070;
 
-    static constexpr std::uint8_t hexToBinary(const char c) noexcept {
-        std::size_t index = c - '0';
-        assert(index < sizeof(hexToBinaryTable));
-        return hexToBinaryTable[index];
+    // Sets bits of `hex` and `colon` for matching characters of `v` and returns
+    // binary values of hex digits, values of other characters are garbage
+    static __m128i classify(__m128i v, std::uint64_t& hex,
+                            std::uint64_t& colon) noexcept {
+        __m128i isColon = _mm_cmpeq_epi8(v, _mm_set1_epi8(':'));
+
+        // unsigned "less or equal" via min, so that characters below '0' or 'a'
+        // wrap around and fail the check
+        __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+        __m128i letter = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        letter = _mm_sub_epi8(letter, _mm_set1_epi8('a'));
+        __m128i isLetter =
+            _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+
+        letter = _mm_add_epi8(letter, _mm_set1_epi8(10));
+        hex = (std::uint32_t)_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter));
+        colon = (std::uint32_t)_mm_movemask_epi8(isColon);
+
+        return _mm_blendv_epi8(digit, letter, isLetter);
     }
 
-    static constexpr bool isAsciiHexDigit(const char c) noexcept {
-        return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+    // Shuffles indexed by the number of pieces before "::" and the total number
+    // of pieces. They keep leading pieces in place, move trailing ones to the end
+    // and zero the gap between them.
+    struct alignas(16) Expansions {
+        std::uint8_t data[MaxPieces][MaxPieces][sizeof(__m128i)];
+    };
+
+    static constexpr Expansions makeExpansions() noexcept {
+        Expansions table{};
+
+        for (std::size_t before = 0; before < MaxPieces; ++before) {
+            for (std::size_t total = before; total < MaxPieces; ++total) {
+                auto gap = MaxPieces - total;
+
+                for (std::size_t i = 0; i < sizeof(__m128i); ++i) {
+                    auto piece = i / sizeof(std::uint16_t);
+                    std::uint8_t index = 0x80;
+
+                    if (piece < before) {
+                        index = (std::uint8_t)i;
+                    } else if (piece >= before + gap) {
+                        index = (std::uint8_t)(i - gap * sizeof(std::uint16_t));
+                    }
+
+                    table.data[before][total][i] = index;
+                }
+            }
+        }
+
+        return table;
     }
+
+    static const Expansions expansions;
 };
 
+inline constexpr Parser6::Expansions Parser6::expansions = Parser6::makeExpansions();
+
 } // namespace netaddr
 
 #endif
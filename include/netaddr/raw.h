@@ -37,6 +37,9 @@ struct Raw {
         _mm_storeu_si128((__m128i*)&data, v0);
     }
 
+    // Bytes in network order, usable in constant expressions
+    constexpr Raw(const Array<std::uint8_t>& bytes) noexcept : data{bytes} {}
+
     template <typename T>
     Raw(const T& val) noexcept {
         set(val);
@@ -74,9 +77,20 @@ struct Raw {
                 data.qwords[1] == other.data.qwords[1]);
     }
 
+    bool operator!=(const Raw& other) const { return !(*this == other); }
+
+    // network order, as in the text of addresses
     bool operator<(const Raw& other) const {
-        return (data.qwords[0] < other.data.qwords[0] ||
-                data.qwords[1] < other.data.qwords[1]);
+        auto lhs = qword(0), rhs = other.qword(0);
+        return lhs < rhs || (lhs == rhs && qword(1) < other.qword(1));
+    }
+
+    // Half `i` of the address in host order, so that comparison of integers
+    // follows network order
+    std::uint64_t qword(std::size_t i) const noexcept {
+        auto hi = ntohl(data.dwords[2 * i]);
+        auto lo = ntohl(data.dwords[2 * i + 1]);
+        return (std::uint64_t)hi << 32 | lo;
     }
 
     std::string dump() const {
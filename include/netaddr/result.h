@@ -0,0 +1,66 @@
+#pragma once
+#ifndef NETADDR_RESULT_H_
+#define NETADDR_RESULT_H_
+
+#include <cassert>
+#include <cstdint>
+
+namespace netaddr {
+
+enum class Error : std::uint8_t {
+    NONE = 0,
+    BAD_IPV4,
+    BAD_IPV6,
+    BAD_PREFIX,
+    PREFIX_OUT_OF_RANGE,
+};
+
+constexpr const char* describe(Error error) noexcept {
+    switch (error) {
+    case Error::NONE:
+        return "no error";
+    case Error::BAD_IPV4:
+        return "malformed IPv4 address";
+    case Error::BAD_IPV6:
+        return "malformed IPv6 address";
+    case Error::BAD_PREFIX:
+        return "malformed subnet prefix";
+    case Error::PREFIX_OUT_OF_RANGE:
+        return "subnet prefix is out of range";
+    }
+
+    return "unknown error";
+}
+
+// Either a value or the reason why it couldn't be made, a poor man's
+// std::expected. It neither allocates nor throws.
+template <typename T>
+class Result {
+  public:
+    Result(const T& value) noexcept : val(value) {}
+
+    Result(Error error) noexcept : err(error) { assert(error != Error::NONE); }
+
+    bool ok() const noexcept { return err == Error::NONE; }
+
+    explicit operator bool() const noexcept { return ok(); }
+
+    Error error() const noexcept { return err; }
+
+    const T& value() const noexcept {
+        assert(ok());
+        return val;
+    }
+
+    const T& operator*() const noexcept { return value(); }
+
+    const T* operator->() const noexcept { return &value(); }
+
+  private:
+    T val{};
+    Error err = Error::NONE;
+};
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,304 @@
+#pragma once
+#ifndef NETADDR_SCANNER_H_
+#define NETADDR_SCANNER_H_
+
+#include <string>
+#include <vector>
+
+#include <netaddr/cpu.h>
+#include <netaddr/parser4.h>
+#include <netaddr/parser6.h>
+
+namespace netaddr {
+
+// Extracts addresses from free-form text such as log lines. Characters which
+// may belong to an address, hex digits, dots and colons, are found 64 bytes at
+// a time with vector compares, and every run of them is a candidate validated
+// in place by Parser4 or Parser6. Trailing dots and a lone colon at either end
+// of a run are punctuation, an IPv4 address followed by ":port" matches without
+// the port, and one after "key:" matches without the key. Text may come in
+// chunks, addresses straddling chunks are found too.
+class AddressScanner {
+  public:
+    struct Match {
+        // position in the whole stream of chunks
+        std::size_t offset;
+        std::size_t length;
+        Raw address;
+    };
+
+    // Longer runs are never addresses and are skipped
+    static constexpr std::size_t MaxTokenLength = 64;
+
+    AddressScanner() = default;
+
+    ~AddressScanner() = default;
+
+    // Appends addresses of `text` to `output`, returns how many were found
+    static std::size_t scan(std::string_view text, std::vector<Match>& output) {
+        AddressScanner scanner;
+        return scanner.feed(text, output) + scanner.finish(output);
+    }
+
+    // Scans the next chunk of a stream. A run touching the end of the chunk
+    // waits for the next one or finish().
+    std::size_t feed(std::string_view chunk, std::vector<Match>& output) {
+        auto before = output.size();
+        std::uint64_t masks[StretchSize / BlockSize];
+        // the previous character belongs to a run, start of the run in `chunk`
+        std::uint64_t previous = open;
+        std::size_t start = 0;
+
+        for (std::size_t stretch = 0; stretch < chunk.size(); stretch += StretchSize) {
+            auto part = chunk.substr(stretch, StretchSize);
+            classify(part, masks);
+
+            for (std::size_t block = 0; block * BlockSize < part.size(); ++block) {
+                auto rest = part.size() - block * BlockSize;
+                auto valid = rest >= BlockSize ? ~0ULL : (1ULL << rest) - 1;
+                auto mask = masks[block];
+
+                // runs start and stop where a character differs from the previous one
+                auto events = (mask ^ (mask << 1 | previous)) & valid;
+                previous = mask >> (BlockSize - 1);
+
+                for (; events; events &= events - 1) {
+                    auto bit = simd::lowestBit(events);
+                    auto pos = stretch + block * BlockSize + bit;
+
+                    if ((mask >> bit) & 1) {
+                        start = pos;
+                        open = true;
+                    } else {
+                        stop(chunk, start, pos, output);
+                    }
+                }
+            }
+        }
+
+        // the run touching the end goes on in the next chunk
+        if (open) {
+            if (!carried) {
+                carry.clear();
+                carryOffset = consumed + start;
+                carried = true;
+            }
+            if (carry.size() + chunk.size() - start <= MaxTokenLength) {
+                carry.append(chunk.substr(start));
+            } else {
+                overlong = true;
+            }
+        }
+
+        consumed += chunk.size();
+
+        return output.size() - before;
+    }
+
+    // Ends the stream, the scanner is ready for the next one
+    std::size_t finish(std::vector<Match>& output) {
+        auto before = output.size();
+
+        if (open && !overlong) {
+            validate(carry, carryOffset, output);
+        }
+
+        open = carried = overlong = false;
+        carry.clear();
+        consumed = 0;
+
+        return output.size() - before;
+    }
+
+  private:
+    static constexpr std::size_t BlockSize = 64;
+    // bytes classified before walking through their masks
+    static constexpr std::size_t StretchSize = 64 * BlockSize;
+
+    // Ends the run from `start` to `pos` of `chunk` or from the previous chunks
+    void stop(std::string_view chunk, std::size_t start, std::size_t pos,
+              std::vector<Match>& output) {
+        if (!carried) {
+            validate(chunk.substr(start, pos - start), consumed + start, output);
+        } else if (!overlong && carry.size() + pos <= MaxTokenLength) {
+            carry.append(chunk.substr(0, pos));
+            validate(carry, carryOffset, output);
+        }
+
+        open = carried = overlong = false;
+    }
+
+    static void validate(std::string_view token, std::size_t offset,
+                         std::vector<Match>& output) {
+        if (token.size() > MaxTokenLength) {
+            return;
+        }
+
+        // punctuation, no address ends with a dot or a single colon
+        while (!token.empty() && token.back() == '.') {
+            token.remove_suffix(1);
+        }
+        auto size = token.size();
+        if (size >= 2 && token[size - 1] == ':' && token[size - 2] != ':') {
+            token.remove_suffix(1);
+        }
+        // nor starts with one, as after "key:"
+        if (token.size() >= 2 && token[0] == ':' && token[1] != ':') {
+            token.remove_prefix(1);
+            ++offset;
+        }
+
+        auto colon = token.find(':');
+        auto dot = token.find('.');
+        Raw address;
+
+        if (colon == token.npos) {
+            if (dot != token.npos && Parser4::parse(token, address)) {
+                output.push_back({offset, token.size(), address});
+            }
+        } else if (Parser6::parse(token, address)) {
+            output.push_back({offset, token.size(), address});
+        } else if (dot < colon && Parser4::parse(token.substr(0, colon), address)) {
+            // "a.b.c.d:port"
+            output.push_back({offset, colon, address});
+        } else if (auto last = token.rfind(':');
+                   dot > last && dot != token.npos &&
+                   Parser4::parse(token.substr(last + 1), address)) {
+            // "key:a.b.c.d" with a key ending in hex letters, as "src:"
+            output.push_back({offset + last + 1, token.size() - last - 1, address});
+        }
+    }
+
+    // Bit i of masks[j] is set if byte 64 * j + i of `part` may belong to an
+    // address, `part` is at most StretchSize bytes
+    static void classify(std::string_view part, std::uint64_t* masks) noexcept {
+        switch (Cpu::level()) {
+        case Cpu::Level::SCALAR:
+            classifyScalar(part, masks);
+            break;
+        case Cpu::Level::SSE42:
+            classifySse42(part, 0, masks);
+            break;
+        case Cpu::Level::AVX2:
+            classifyAvx2(part, masks);
+            break;
+        case Cpu::Level::AVX512:
+            classifyAvx512(part, masks);
+            break;
+        }
+    }
+
+    static void classifyScalar(std::string_view part, std::uint64_t* masks) noexcept {
+        for (std::size_t block = 0; block * BlockSize < part.size(); ++block) {
+            masks[block] = 0;
+        }
+
+        for (std::size_t i = 0; i < part.size(); ++i) {
+            auto c = (unsigned char)part[i];
+            bool hex = ((unsigned)(c - '0') <= 9) || ((unsigned)((c | 0x20) - 'a') <= 5);
+            bool member = hex || c == '.' || c == ':';
+            masks[i / BlockSize] |= (std::uint64_t)member << (i % BlockSize);
+        }
+    }
+
+    // 16 bytes at a time starting from block `from`, bytes past the end of
+    // `part` are zeros, which never belong to addresses
+    static void classifySse42(std::string_view part, std::size_t from,
+                              std::uint64_t* masks) noexcept {
+        constexpr std::size_t Lanes = BlockSize / sizeof(__m128i);
+
+        for (std::size_t block = from; block * BlockSize < part.size(); ++block) {
+            std::uint64_t mask = 0;
+
+            for (std::size_t lane = 0; lane < Lanes; ++lane) {
+                auto v = simd::load(part, block * Lanes + lane);
+
+                auto digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+                auto isDigit =
+                    _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+                auto letter = _mm_or_si128(v, _mm_set1_epi8(0x20));
+                letter = _mm_sub_epi8(letter, _mm_set1_epi8('a'));
+                auto isLetter =
+                    _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+                auto isDot = _mm_cmpeq_epi8(v, _mm_set1_epi8('.'));
+                auto isColon = _mm_cmpeq_epi8(v, _mm_set1_epi8(':'));
+
+                auto member = _mm_or_si128(_mm_or_si128(isDigit, isLetter),
+                                           _mm_or_si128(isDot, isColon));
+                mask |= (std::uint64_t)(std::uint32_t)_mm_movemask_epi8(member)
+                        << (lane * sizeof(__m128i));
+            }
+
+            masks[block] = mask;
+        }
+    }
+
+    // 32 bytes at a time, the last partial block goes to classifySse42()
+    NETADDR_TARGET_AVX2
+    static void classifyAvx2(std::string_view part, std::uint64_t* masks) noexcept {
+        std::size_t block = 0;
+
+        for (; (block + 1) * BlockSize <= part.size(); ++block) {
+            std::uint64_t mask = 0;
+
+            for (std::size_t lane = 0; lane < 2; ++lane) {
+                auto* data = part.data() + block * BlockSize + lane * sizeof(__m256i);
+                auto v = _mm256_loadu_si256((const __m256i*)data);
+
+                auto digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+                auto isDigit =
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+                auto letter = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+                letter = _mm256_sub_epi8(letter, _mm256_set1_epi8('a'));
+                auto isLetter = _mm256_cmpeq_epi8(
+                    _mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+                auto isDot = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'));
+                auto isColon = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':'));
+
+                auto member = _mm256_or_si256(_mm256_or_si256(isDigit, isLetter),
+                                              _mm256_or_si256(isDot, isColon));
+                mask |= (std::uint64_t)(std::uint32_t)_mm256_movemask_epi8(member)
+                        << (lane * sizeof(__m256i));
+            }
+
+            masks[block] = mask;
+        }
+
+        classifySse42(part, block, masks);
+    }
+
+    // 64 bytes at a time, the last partial block goes to classifySse42()
+    NETADDR_TARGET_AVX512
+    static void classifyAvx512(std::string_view part, std::uint64_t* masks) noexcept {
+        std::size_t block = 0;
+
+        for (; (block + 1) * BlockSize <= part.size(); ++block) {
+            auto v = _mm512_loadu_si512((const void*)(part.data() + block * BlockSize));
+
+            auto digit = _mm512_sub_epi8(v, _mm512_set1_epi8('0'));
+            auto letter = _mm512_sub_epi8(_mm512_or_si512(v, _mm512_set1_epi8(0x20)),
+                                          _mm512_set1_epi8('a'));
+
+            masks[block] = _mm512_cmple_epu8_mask(digit, _mm512_set1_epi8(9)) |
+                           _mm512_cmple_epu8_mask(letter, _mm512_set1_epi8(5)) |
+                           _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('.')) |
+                           _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':'));
+        }
+
+        classifySse42(part, block, masks);
+    }
+
+    std::string carry;
+    // stream offsets of the carried run and of the next chunk
+    std::size_t carryOffset = 0;
+    std::size_t consumed = 0;
+    // a run is open at the end of the stream so far, it began in an earlier
+    // chunk and it's too long to be an address
+    bool open = false;
+    bool carried = false;
+    bool overlong = false;
+};
+
+} // namespace netaddr
+
+#endif
@@ -0,0 +1,315 @@
+#pragma once
+#ifndef NETADDR_SHAREDLPM_H_
+#define NETADDR_SHAREDLPM_H_
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <netaddr/lpm6.h>
+
+namespace netaddr {
+
+// Longest prefix match table shared between threads which look addresses up
+// and threads which change routes, RCU style. Readers take the current
+// immutable snapshot in a few atomic operations, never waiting for anyone.
+// Writers apply batches of changes to a copy, build its Lpm6 once per batch and
+// publish it atomically. Replaced snapshots are freed once no reader may hold
+// them, which readers announce with epochs in per-thread slots.
+template <typename Value>
+class SharedLpm {
+    struct Slot;
+
+  public:
+    using Route = std::pair<Subnet, Value>;
+
+    // concurrent Reader objects
+    static constexpr std::size_t MaxReaders = 256;
+
+    // An immutable version of the table
+    class Snapshot {
+      public:
+        const Value* lookup(const Raw& address) const noexcept {
+            return value(lpm.lookup(address));
+        }
+
+        const Value* lookup(const Subnet& address) const noexcept {
+            return value(lpm.lookup(address));
+        }
+
+        // sorted by subnet
+        const std::vector<Route>& routes() const noexcept { return sorted; }
+
+        std::uint64_t version() const noexcept { return number; }
+
+      private:
+        friend class SharedLpm;
+
+        // the trie keeps indices of routes, so that values aren't stored twice
+        using Index = std::uint32_t;
+
+        Snapshot(std::vector<Route> routes, std::uint64_t version)
+            : sorted(std::move(routes)), lpm(indices(sorted)), number(version) {}
+
+        static std::vector<typename Lpm6<Index>::Route> indices(
+            const std::vector<Route>& routes) {
+            std::vector<typename Lpm6<Index>::Route> result;
+            result.reserve(routes.size());
+
+            for (std::size_t i = 0; i < routes.size(); ++i) {
+                result.emplace_back(routes[i].first, (Index)i);
+            }
+
+            return result;
+        }
+
+        const Value* value(const Index* index) const noexcept {
+            return index ? &sorted[*index].second : nullptr;
+        }
+
+        std::vector<Route> sorted;
+        Lpm6<Index> lpm;
+        std::uint64_t number;
+    };
+
+    // A read-side critical section, snapshot() and values found in it stay
+    // valid until the guard is destroyed
+    class Guard {
+      public:
+        Guard(Guard&& other) noexcept : slot(other.slot), current(other.current) {
+            other.slot = nullptr;
+        }
+
+        Guard& operator=(Guard&&) = delete;
+
+        Guard(const Guard&) = delete;
+
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            if (slot) {
+                slot->store(Idle, std::memory_order_release);
+            }
+        }
+
+        const Snapshot& snapshot() const noexcept { return *current; }
+
+        const Snapshot* operator->() const noexcept { return current; }
+
+      private:
+        friend class SharedLpm;
+
+        Guard(std::atomic<std::uint64_t>* readerSlot, const SharedLpm& table) noexcept
+            : slot(readerSlot) {
+            // the writer either sees the epoch or has already published the
+            // snapshot loaded below
+            slot->store(table.epoch.load(std::memory_order_seq_cst),
+                        std::memory_order_seq_cst);
+            current = table.current.load(std::memory_order_seq_cst);
+        }
+
+        std::atomic<std::uint64_t>* slot;
+        const Snapshot* current;
+    };
+
+    // A thread's handle for reading, it owns a slot of the table until
+    // destroyed and has at most one Guard at a time
+    class Reader {
+      public:
+        Reader(Reader&& other) noexcept : table(other.table), slot(other.slot) {
+            other.slot = nullptr;
+        }
+
+        Reader& operator=(Reader&&) = delete;
+
+        Reader(const Reader&) = delete;
+
+        Reader& operator=(const Reader&) = delete;
+
+        ~Reader() {
+            if (slot) {
+                slot->taken.store(false, std::memory_order_release);
+            }
+        }
+
+        Guard pin() const noexcept { return Guard(&slot->epoch, *table); }
+
+        // Copies the value of the longest prefix containing `address`
+        template <typename Address>
+        bool lookup(const Address& address, Value& value) const {
+            auto guard = pin();
+            auto* found = guard->lookup(address);
+            if (found) {
+                value = *found;
+            }
+
+            return found;
+        }
+
+      private:
+        friend class SharedLpm;
+
+        Reader(const SharedLpm* owner, Slot* readerSlot) noexcept
+            : table(owner), slot(readerSlot) {}
+
+        const SharedLpm* table;
+        Slot* slot;
+    };
+
+    // If the same subnet comes more than once, the last one wins
+    explicit SharedLpm(std::vector<Route> routes = {}) {
+        current.store(new Snapshot(normalize(std::move(routes)), 0));
+    }
+
+    SharedLpm(const SharedLpm&) = delete;
+
+    SharedLpm& operator=(const SharedLpm&) = delete;
+
+    // No reader may be left
+    ~SharedLpm() {
+        delete current.load();
+        for (auto& item : retired) {
+            delete item.snapshot;
+        }
+    }
+
+    // Throws std::runtime_error if MaxReaders readers exist
+    Reader reader() const {
+        for (auto& slot : slots) {
+            if (!slot.taken.exchange(true, std::memory_order_acquire)) {
+                return Reader(this, &slot);
+            }
+        }
+
+        throw std::runtime_error("too many readers of SharedLpm");
+    }
+
+    // Removes `removals`, then adds or replaces `inserts` and publishes the
+    // result, returns its version. Writers are serialized, readers go on with
+    // the previous snapshot meanwhile.
+    std::uint64_t update(std::vector<Route> inserts, std::vector<Subnet> removals = {}) {
+        std::lock_guard<std::mutex> lock(writer);
+
+        auto* old = current.load(std::memory_order_relaxed);
+        auto routes = merge(old->sorted, normalize(std::move(inserts)), removals);
+        auto* fresh = new Snapshot(std::move(routes), old->number + 1);
+
+        current.store(fresh, std::memory_order_seq_cst);
+        // readers which announce this epoch or a later one can't see `old`
+        auto retiredAt = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        retired.push_back({old, retiredAt});
+
+        collect();
+
+        return fresh->number;
+    }
+
+    // Frees replaced snapshots no reader may hold, update() does it as well
+    void reclaim() {
+        std::lock_guard<std::mutex> lock(writer);
+        collect();
+    }
+
+    // snapshots waiting for readers to leave
+    std::size_t pending() const {
+        std::lock_guard<std::mutex> lock(writer);
+        return retired.size();
+    }
+
+  private:
+    static constexpr std::uint64_t Idle = 0;
+    static constexpr std::size_t CacheLine = 64;
+
+    struct alignas(CacheLine) Slot {
+        // the epoch a reader entered its critical section at or Idle
+        std::atomic<std::uint64_t> epoch{Idle};
+        std::atomic<bool> taken{false};
+    };
+
+    struct Retired {
+        const Snapshot* snapshot;
+        std::uint64_t epoch;
+    };
+
+    static bool less(const Route& lhs, const Route& rhs) { return lhs.first < rhs.first; }
+
+    // Sorts routes by subnet keeping the last of equal ones
+    static std::vector<Route> normalize(std::vector<Route> routes) {
+        std::stable_sort(routes.begin(), routes.end(), less);
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < routes.size(); ++i) {
+            if (kept && routes[kept - 1].first == routes[i].first) {
+                routes[kept - 1] = std::move(routes[i]);
+            } else if (kept++ != i) {
+                routes[kept - 1] = std::move(routes[i]);
+            }
+        }
+        routes.erase(routes.begin() + kept, routes.end());
+
+        return routes;
+    }
+
+    static std::vector<Route> merge(const std::vector<Route>& routes,
+                                    const std::vector<Route>& inserts,
+                                    std::vector<Subnet> removals) {
+        std::sort(removals.begin(), removals.end());
+
+        std::vector<Route> result;
+        result.reserve(routes.size() + inserts.size());
+
+        auto removed = removals.begin();
+        auto inserted = inserts.begin();
+        for (const auto& route : routes) {
+            while (inserted != inserts.end() && less(*inserted, route)) {
+                result.push_back(*inserted++);
+            }
+            if (inserted != inserts.end() && inserted->first == route.first) {
+                result.push_back(*inserted++);
+                continue;
+            }
+
+            removed = std::lower_bound(removed, removals.end(), route.first);
+            if (removed == removals.end() || !(*removed == route.first)) {
+                result.push_back(route);
+            }
+        }
+        result.insert(result.end(), inserted, inserts.end());
+
+        return result;
+    }
+
+    // Frees retired snapshots older than the oldest epoch of active readers
+    void collect() {
+        auto oldest = ~Idle;
+        for (const auto& slot : slots) {
+            auto value = slot.epoch.load(std::memory_order_seq_cst);
+            if (value != Idle) {
+                oldest = std::min(oldest, value);
+            }
+        }
+
+        auto kept = std::remove_if(retired.begin(), retired.end(), [oldest](auto& item) {
+            if (item.epoch > oldest) {
+                return false;
+            }
+            delete item.snapshot;
+            return true;
+        });
+        retired.erase(kept, retired.end());
+    }
+
+    // epochs start at 1, Idle marks readers out of critical sections
+    std::atomic<std::uint64_t> epoch{1};
+    std::atomic<const Snapshot*> current{nullptr};
+    mutable Slot slots[MaxReaders];
+
+    mutable std::mutex writer;
+    std::vector<Retired> retired;
+};
+
+} // namespace netaddr
+
+#endif
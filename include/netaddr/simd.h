@@ -0,0 +1,125 @@
+#pragma once
+#ifndef NETADDR_SIMD_H_
+#define NETADDR_SIMD_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include <immintrin.h>
+
+#include <netaddr/padded.h>
+
+namespace netaddr {
+
+namespace simd {
+
+// sliding window of shuffles, 16 bytes at `shifts + n` shift a vector
+// n bytes down, at `shifts - n` shift it n bytes up with zeros shifted in
+inline constexpr std::uint8_t shiftsTable[] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0,    1,    2,    3,    4,    5,    6,    7,
+    8,    9,    10,   11,   12,   13,   14,   15,   0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+inline constexpr const std::uint8_t* shifts = shiftsTable + sizeof(__m128i);
+
+// sliding window of masks, 16 bytes at `masks - n` keep the first n bytes
+inline constexpr std::uint8_t masksTable[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0,    0,    0,    0,    0,    0,
+    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+};
+
+inline constexpr const std::uint8_t* masks = masksTable + sizeof(__m128i);
+
+// Zeroes all bytes of `v` starting from `count`
+inline __m128i keep(__m128i v, std::size_t count) noexcept {
+    auto mask = _mm_loadu_si128((const __m128i*)(masks - count));
+    return _mm_and_si128(v, mask);
+}
+
+// Loads 16 bytes of chunk `index` of `input` padded with zeros. It never reads
+// past the end of `input` and avoids a stack copy, which would stall on store
+// forwarding when loaded back.
+inline __m128i load(std::string_view input, std::size_t index) noexcept {
+    auto* data = input.data();
+    auto sz = input.size();
+    auto offset = index * sizeof(__m128i);
+
+    if (offset + sizeof(__m128i) <= sz) {
+        return _mm_loadu_si128((const __m128i*)(data + offset));
+    }
+
+    if (offset >= sz) {
+        return _mm_setzero_si128();
+    }
+
+    auto rest = sz - offset;
+    if (sz >= sizeof(__m128i)) {
+        // load the last 16 bytes and shift them down to the chunk start
+        auto v = _mm_loadu_si128((const __m128i*)(data + sz - sizeof(__m128i)));
+        auto shift = sizeof(__m128i) - rest;
+        auto shuf = _mm_loadu_si128((const __m128i*)(shifts + shift));
+        return _mm_shuffle_epi8(v, shuf);
+    }
+
+    // short input, combine two overlapping loads of the same width
+    std::uint64_t lo = 0, hi = 0;
+    std::size_t width = 1;
+    if (sz >= sizeof(std::uint64_t)) {
+        width = sizeof(std::uint64_t);
+    } else if (sz >= sizeof(std::uint32_t)) {
+        width = sizeof(std::uint32_t);
+    } else if (sz >= sizeof(std::uint16_t)) {
+        width = sizeof(std::uint16_t);
+    }
+    memcpy(&lo, data, width);
+    memcpy(&hi, data + sz - width, width);
+
+    auto shuf = _mm_loadu_si128((const __m128i*)(shifts - sz + width));
+    auto tail = _mm_shuffle_epi8(_mm_cvtsi64_si128((long long)hi), shuf);
+    return _mm_or_si128(_mm_cvtsi64_si128((long long)lo), tail);
+}
+
+// Same as above for padded input, a single load reading into the padding at
+// most
+inline __m128i load(PaddedStringView input, std::size_t index) noexcept {
+    auto offset = index * sizeof(__m128i);
+    if (offset >= input.size()) {
+        return _mm_setzero_si128();
+    }
+
+    auto v = _mm_loadu_si128((const __m128i*)(input.data() + offset));
+    return keep(v, std::min(input.size() - offset, sizeof(__m128i)));
+}
+
+// Index of the lowest set bit, `mask` must not be zero
+inline std::uint32_t lowestBit(std::uint64_t mask) noexcept {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#else
+    return (std::uint32_t)__builtin_ctzll(mask);
+#endif
+}
+
+// Index of the highest set bit, `mask` must not be zero
+inline std::uint32_t highestBit(std::uint64_t mask) noexcept {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return index;
+#else
+    return (std::uint32_t)(63 - __builtin_clzll(mask));
+#endif
+}
+
+} // namespace simd
+
+} // namespace netaddr
+
+#endif
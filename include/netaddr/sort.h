@@ -0,0 +1,183 @@
+#pragma once
+#ifndef NETADDR_SORT_H_
+#define NETADDR_SORT_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <netaddr/parallel.h>
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// LSD radix sort of addresses and subnets in the order of their operator<.
+// Histograms of all digits are collected in a single pass, and digits which are
+// the same for every item are skipped, so IPv4 only data takes 4 passes out of
+// 16. Data with more than MaxPasses varying digits, such as random IPv6
+// addresses, is left to comparison sorts, which win there, so the gain is for
+// IPv4 and for IPv6 from a few networks. Both sorts are stable for subnets.
+//
+// With several threads every pass splits the data into one chunk per thread:
+// each thread counts digits of its chunk, and then scatters the chunk to the
+// offsets of its own histogram, which follow the ones of the previous chunks
+// in each bucket, so the order stays stable.
+class Sorter {
+  public:
+    // Sorts on up to `threads` threads, as parallel::threads() picks them
+    static void sort(Raw* data, std::size_t count, std::size_t threads = 1) {
+        if (count < MinRadixCount) {
+            std::sort(data, data + count);
+            return;
+        }
+
+        // digit 0 is the least significant byte
+        auto digitOf = [](const Raw& item, std::size_t digit) {
+            return item.data.bytes[SizeIPv6 - 1 - digit];
+        };
+        if (!radix(data, count, SizeIPv6, digitOf, threads)) {
+            std::sort(data, data + count);
+        }
+    }
+
+    static void sort(Subnet* data, std::size_t count, std::size_t threads = 1) {
+        if (count < MinRadixCount) {
+            std::stable_sort(data, data + count);
+            return;
+        }
+
+        // the prefix length is the least significant digit, it never exceeds 128
+        auto digitOf = [](const Subnet& item, std::size_t digit) {
+            auto& bytes = item.raw().data.bytes;
+            return digit ? bytes[SizeIPv6 - digit] : (std::uint8_t)item.length();
+        };
+        if (!radix(data, count, SizeIPv6 + 1, digitOf, threads)) {
+            std::stable_sort(data, data + count);
+        }
+    }
+
+  private:
+    static constexpr std::size_t MinRadixCount = 256;
+    static constexpr std::size_t MaxPasses = 8;
+    static constexpr std::size_t Buckets = 256;
+    // smaller chunks aren't worth a thread
+    static constexpr std::size_t MinChunkSize = 64 * 1024;
+
+    // Returns false and leaves `data` as is if it takes more than MaxPasses
+    template <typename T, typename Digit>
+    static bool radix(T* data, std::size_t count, std::size_t digits, Digit digitOf,
+                      std::size_t threads) {
+        threads = parallel::threads(threads, count, MinChunkSize);
+
+        // items [first(i), first(i + 1)) are the chunk of thread i
+        auto first = [count, threads](std::size_t i) { return count / threads * i; };
+        auto last = [count, threads, first](std::size_t i) {
+            return i + 1 == threads ? count : first(i + 1);
+        };
+
+        // digits where every item goes to the same bucket are skipped, they are
+        // found before histograms to give up early
+        std::vector<std::uint8_t> differs(threads * digits);
+        parallel::run(threads, [&](std::size_t i) {
+            auto* found = &differs[i * digits];
+            for (std::size_t j = std::max<std::size_t>(first(i), 1); j < last(i); ++j) {
+                for (std::size_t digit = 0; digit < digits; ++digit) {
+                    found[digit] |= digitOf(data[j], digit) ^ digitOf(data[0], digit);
+                }
+            }
+        });
+
+        std::vector<std::size_t> varying;
+        for (std::size_t digit = 0; digit < digits; ++digit) {
+            std::uint8_t found = 0;
+            for (std::size_t i = 0; i < threads; ++i) {
+                found |= differs[i * digits + digit];
+            }
+            if (found) {
+                varying.push_back(digit);
+            }
+        }
+
+        if (varying.size() > MaxPasses) {
+            return false;
+        }
+
+        std::vector<T> buffer(count);
+        T* from = data;
+        T* to = buffer.data();
+
+        if (threads == 1) {
+            std::vector<std::size_t> histograms(varying.size() * Buckets);
+            for (std::size_t i = 0; i < count; ++i) {
+                for (std::size_t pass = 0; pass < varying.size(); ++pass) {
+                    ++histograms[pass * Buckets + digitOf(data[i], varying[pass])];
+                }
+            }
+
+            for (std::size_t pass = 0; pass < varying.size(); ++pass) {
+                auto* offsets = &histograms[pass * Buckets];
+                prefixSums(offsets, 1);
+                scatter(from, to, 0, count, offsets, varying[pass], digitOf);
+                std::swap(from, to);
+            }
+        } else {
+            // chunks move between passes, so every pass counts digits again
+            std::vector<std::size_t> histograms(threads * Buckets);
+
+            for (auto digit : varying) {
+                parallel::run(threads, [&](std::size_t i) {
+                    auto* histogram = &histograms[i * Buckets];
+                    std::fill(histogram, histogram + Buckets, 0);
+                    for (std::size_t j = first(i); j < last(i); ++j) {
+                        ++histogram[digitOf(from[j], digit)];
+                    }
+                });
+
+                prefixSums(histograms.data(), threads);
+                parallel::run(threads, [&](std::size_t i) {
+                    auto* offsets = &histograms[i * Buckets];
+                    scatter(from, to, first(i), last(i), offsets, digit, digitOf);
+                });
+                std::swap(from, to);
+            }
+        }
+
+        if (from != data) {
+            std::copy(from, from + count, data);
+        }
+
+        return true;
+    }
+
+    // Turns `chunks` consecutive histograms into offsets where items of each
+    // chunk go, bucket by bucket, and chunk by chunk within a bucket
+    static void prefixSums(std::size_t* histograms, std::size_t chunks) noexcept {
+        std::size_t offset = 0;
+        for (std::size_t bucket = 0; bucket < Buckets; ++bucket) {
+            for (std::size_t i = 0; i < chunks; ++i) {
+                auto size = histograms[i * Buckets + bucket];
+                histograms[i * Buckets + bucket] = offset;
+                offset += size;
+            }
+        }
+    }
+
+    template <typename T, typename Digit>
+    static void scatter(const T* from, T* to, std::size_t begin, std::size_t end,
+                        std::size_t* offsets, std::size_t digit, Digit digitOf) noexcept {
+        for (std::size_t i = begin; i < end; ++i) {
+            to[offsets[digitOf(from[i], digit)]++] = from[i];
+        }
+    }
+};
+
+inline void radixSort(std::vector<Raw>& v, std::size_t threads = 1) {
+    Sorter::sort(v.data(), v.size(), threads);
+}
+
+inline void radixSort(std::vector<Subnet>& v, std::size_t threads = 1) {
+    Sorter::sort(v.data(), v.size(), threads);
+}
+
+} // namespace netaddr
+
+#endif
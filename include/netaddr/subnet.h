@@ -5,8 +5,10 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include <netaddr/formatter.h>
 #include <netaddr/parser4.h>
 #include <netaddr/parser6.h>
+#include <netaddr/result.h>
 
 namespace netaddr {
 
@@ -14,11 +16,27 @@ class Subnet {
   public:
     using Prefix = std::size_t;
 
+    static constexpr Prefix IPv6MaxPrefix = 128;
+    static constexpr Prefix IPv4MaxPrefix = 32;
+    // IPv4 subnets are kept mapped to IPv6, see raw() and length()
+    static constexpr Prefix IPv4PrefixOffset = IPv6MaxPrefix - IPv4MaxPrefix;
+
+    enum class Protocol : std::uint8_t {
+        NONE = AF_UNSPEC,
+        IPV4 = AF_INET,
+        IPV6 = AF_INET6
+    };
+
     bool empty() { return proto == Protocol::NONE; }
 
-    bool v4() const noexcept { return proto == Protocol::IPV4; }
+    constexpr bool v4() const noexcept { return proto == Protocol::IPV4; }
 
-    bool v6() const noexcept { return proto == Protocol::IPV6; };
+    constexpr bool v6() const noexcept { return proto == Protocol::IPV6; };
+
+    // IPv4 or IPv6 mapped to IPv4 according RFC4038
+    constexpr bool mapped() const noexcept {
+        return flags & static_cast<FlagsType>(Flags::MAPPED);
+    }
 
     auto addr4() const noexcept { return addr.data.v4.in_addr; }
 
@@ -28,16 +46,23 @@ class Subnet {
 
     auto mask6() const noexcept { return mask.data.v6.in_addr; }
 
-    auto cidr() const noexcept {
+    constexpr auto cidr() const noexcept {
         return (proto == Protocol::IPV6) ? prefix : (prefix - IPv4PrefixOffset);
     }
 
+    // The masked address, IPv4 is mapped to IPv6 as in ::ffff:a.b.c.d
+    constexpr const Raw& raw() const noexcept { return addr; }
+
+    // The prefix length of raw(), cidr() + IPv4PrefixOffset for IPv4
+    constexpr Prefix length() const noexcept { return prefix; }
+
     bool operator==(const Subnet& other) const {
         return (addr == other.addr && prefix == other.prefix);
     }
 
+    // by address in network order, then by prefix length
     bool operator<(const Subnet& other) const {
-        return (addr < other.addr || prefix < other.prefix);
+        return addr < other.addr || (addr == other.addr && prefix < other.prefix);
     }
 
     bool belongs(const Subnet& parent) const noexcept {
@@ -59,31 +84,101 @@ class Subnet {
 
     Subnet() = default;
 
+    // `address` and `length` as of raw() and length(), the address is masked.
+    // IPv6 hosts in ::ffff:0:0/96 are mapped as if they were parsed.
+    Subnet(const Raw& address, Prefix length, Protocol protocol) noexcept
+        : addr(address), prefix(length), proto(protocol) {
+        if (proto == Protocol::IPV4) {
+            flags = static_cast<FlagsType>(Flags::IPV4) |
+                    static_cast<FlagsType>(Flags::MAPPED);
+        } else if (proto == Protocol::IPV6) {
+            flags = static_cast<FlagsType>(Flags::IPV6);
+            if (prefix == IPv6MaxPrefix) {
+                mapping6();
+            }
+        }
+        masking();
+    }
+
     Subnet(const char* input) : Subnet(std::string_view{input}){};
 
-    Subnet(const std::string_view input) : Subnet() {
-        suggest(input);
+    Subnet(const std::string_view input) : Subnet() { raise(assign(input)); }
 
-        auto addr = split(input);
-        parse(addr);
-    }
+    // Loads straight from padded input, see PaddedStringView
+    explicit Subnet(PaddedStringView input) : Subnet() { raise(assign(input)); }
 
     ~Subnet() = default;
 
+    // Same as the constructor, but reports malformed input instead of throwing
+    static Result<Subnet> tryParse(std::string_view input) noexcept {
+        return make(input);
+    }
+
+    static Result<Subnet> tryParse(PaddedStringView input) noexcept {
+        return make(input);
+    }
+
+    // Same as the constructor in constant expressions, but without SIMD, so the
+    // constructor is faster at run time. Throws std::invalid_argument, which
+    // fails compilation of constant expressions.
+    static constexpr Subnet parseConst(std::string_view input) {
+        return literal(input, true);
+    }
+
     std::string dump() const { return addr.dump() + "{" + mask.dump() + "}"; }
 
-  protected:
-    static constexpr Prefix IPv6MaxPrefix = 128;
-    static constexpr Prefix IPv4MaxPrefix = 32;
-    static constexpr Prefix IPv4PrefixOffset = IPv6MaxPrefix - IPv4MaxPrefix;
+    // Writes text of the subnet, the prefix length goes only if it's shorter than
+    // the address. `output` must have room for Formatter::BufferSize bytes, the
+    // text isn't null-terminated. Returns the end of the text.
+    char* toChars(char* output) const noexcept {
+        if (proto == Protocol::NONE) {
+            return output;
+        }
 
-    using FlagsType = std::uint8_t;
+        if (v4()) {
+            output = Formatter::format4(addr.data.dwords[3], output);
+        } else if (mapped()) {
+            // RFC 5952 section 5
+            constexpr std::string_view Mapped = "::ffff:";
+            memcpy(output, Mapped.data(), Mapped.size());
+            output = Formatter::format4(addr.data.dwords[3], output + Mapped.size());
+        } else {
+            output = Formatter::format6(addr, output);
+        }
 
-    enum class Protocol : std::uint8_t {
-        NONE = AF_UNSPEC,
-        IPV4 = AF_INET,
-        IPV6 = AF_INET6
-    };
+        auto max = v4() ? IPv4MaxPrefix : IPv6MaxPrefix;
+        if (cidr() < max) {
+            output = Formatter::formatPrefix(cidr(), output);
+        }
+
+        return output;
+    }
+
+    std::string str() const {
+        char buf[Formatter::BufferSize];
+        return std::string(buf, toChars(buf));
+    }
+
+    // Netmask of a prefix length in terms of length(), longer ones are hosts
+    static __m128i bitmask(Prefix value) noexcept {
+        auto shift0 = _mm_cvtsi32_si128((int)value);
+        auto shift1 = _mm_set1_epi64x(64);
+        auto shift2 = _mm_set1_epi64x(128);
+        auto shift3 = _mm_subs_epu16(shift1, shift0);
+        auto shift4 = _mm_subs_epu16(shift2, shift0);
+
+        auto mask0 = _mm_set_epi64x(-1, 0);
+        auto mask1 = _mm_set_epi64x(0, -1);
+        auto mask2 = _mm_sll_epi64(mask0, shift3);
+        auto mask3 = _mm_sll_epi64(mask1, shift4);
+        auto mask5 = _mm_or_si128(mask2, mask3);
+
+        auto shmask = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        return _mm_shuffle_epi8(mask5, shmask);
+    }
+
+  protected:
+    using FlagsType = std::uint8_t;
 
     enum class Flags : FlagsType {
         IPV4 = (1 << 0),
@@ -91,18 +186,126 @@ class Subnet {
         MAPPED = (1 << 2),
     };
 
-    void suggest(std::string_view input) {
+    constexpr Subnet(const Raw& address, const Raw& netmask, Prefix length,
+                     Protocol protocol, FlagsType bits) noexcept
+        : addr(address), mask(netmask), prefix(length), proto(protocol), flags(bits) {}
+
+    static constexpr void raise(Error error) {
+        if (error != Error::NONE) {
+            throw std::invalid_argument(describe(error));
+        }
+    }
+
+    // Parsing of constant expressions, which follows assign() or Address
+    // parsing if `withPrefix` is false, step by step
+    static constexpr Subnet literal(std::string_view input, bool withPrefix) {
+        auto protocol = guess(input);
+        Prefix length = (protocol == Protocol::IPV4) ? IPv4MaxPrefix : IPv6MaxPrefix;
+
+        auto it = input.find('/');
+        if (withPrefix && it != input.npos) {
+            auto cidr = input.substr(it + 1);
+            raise(cidr.empty() ? Error::BAD_PREFIX : Error::NONE);
+
+            length = 0;
+            for (auto c : cidr) {
+                raise((c < '0' || c > '9') ? Error::BAD_PREFIX : Error::NONE);
+                length = std::min<Prefix>(length * 10 + (c - '0'), IPv6MaxPrefix + 1);
+            }
+            input = input.substr(0, it);
+        }
+
+        Array<std::uint8_t> bytes{};
+        FlagsType bits = 0;
+
+        if (protocol == Protocol::IPV4) {
+            raise(length > IPv4MaxPrefix ? Error::PREFIX_OUT_OF_RANGE : Error::NONE);
+            raise(Parser4::parseConst(input, bytes) ? Error::NONE : Error::BAD_IPV4);
+
+            length += IPv4PrefixOffset;
+            bits = static_cast<FlagsType>(Flags::IPV4) |
+                   static_cast<FlagsType>(Flags::MAPPED);
+        } else {
+            raise(length > IPv6MaxPrefix ? Error::PREFIX_OUT_OF_RANGE : Error::NONE);
+            raise(Parser6::parseConst(input, bytes) ? Error::NONE : Error::BAD_IPV6);
+
+            // see mapping6()
+            bool mapped = length >= 96 && bytes[10] == 0xFF && bytes[11] == 0xFF;
+            for (std::size_t i = 0; i < 10; ++i) {
+                mapped &= (bytes[i] == 0);
+            }
+
+            length = mapped ? IPv6MaxPrefix : length;
+            bits = static_cast<FlagsType>(Flags::IPV6);
+            bits |= mapped ? static_cast<FlagsType>(Flags::MAPPED) : 0;
+        }
+
+        // see masking()
+        Array<std::uint8_t> netmask{};
+        for (std::size_t i = 0; i < SizeIPv6; ++i) {
+            auto ones = (length > i * 8) ? length - i * 8 : 0;
+            netmask[i] = (ones >= 8) ? 0xFF : (std::uint8_t)(0xFF00 >> ones);
+            bytes[i] &= netmask[i];
+        }
+
+        return Subnet(Raw(bytes), Raw(netmask), length, protocol, bits);
+    }
+
+    // IPv4 if there is a dot in the first piece of `input`, which ends at a
+    // colon in IPv6 such as "::1.2.3.4"
+    static constexpr Protocol guess(std::string_view input) noexcept {
         constexpr auto MinInputLength = std::char_traits<char>::length("x.x.x.x");
 
-        bool dot = false;
+        unsigned dots = 0, colons = 0;
         if (input.size() >= MinInputLength) {
-            dot |= (input[0] == '.');
-            dot |= (input[1] == '.');
-            dot |= (input[2] == '.');
-            dot |= (input[3] == '.');
+            for (unsigned i = 0; i < 4; ++i) {
+                dots |= (unsigned)(input[i] == '.') << i;
+                colons |= (unsigned)(input[i] == ':') << i;
+            }
+        }
+
+        // dots below the lowest colon, all of them without colons
+        bool dot = dots & ((colons & (0U - colons)) - 1);
+        return dot ? Protocol::IPV4 : Protocol::IPV6;
+    }
+
+    template <typename View>
+    static Result<Subnet> make(View input) noexcept {
+        Subnet subnet;
+
+        auto error = subnet.assign(input);
+        if (error != Error::NONE) {
+            return error;
+        }
+
+        return subnet;
+    }
+
+    // `View` is std::string_view or PaddedStringView, a prefix of padded input
+    // is padded as well
+    template <typename View>
+    Error assign(View input) noexcept {
+        suggest(input);
+
+        // IPv4 subnets are parsed in one pass, the slow path below only tells
+        // what's wrong with the input
+        if (proto == Protocol::IPV4 && Parser4::parseCidr(input, addr, mask, prefix)) {
+            flags |= static_cast<FlagsType>(Flags::IPV4);
+            mapping4();
+            return Error::NONE;
+        }
+
+        std::string_view text = input;
+        auto error = split(text);
+        if (error != Error::NONE) {
+            return error;
         }
 
-        proto = dot ? Protocol::IPV4 : Protocol::IPV6;
+        return parse(View(text));
+    }
+
+    void suggest(std::string_view input) noexcept {
+        proto = guess(input);
         prefix = (proto == Protocol::IPV4) ? IPv4MaxPrefix : IPv6MaxPrefix;
     }
 
@@ -121,77 +324,74 @@ class Subnet {
         }
     }
 
-    bool parse(std::string_view input) {
+    template <typename View>
+    Error parse(View input) noexcept {
         return (proto == Protocol::IPV4) ? parse4(input) : parse6(input);
     }
 
-    std::string_view split(std::string_view input) {
-        auto nocidr = input;
-
+    // Cuts the prefix length off `input`. A prefix which doesn't fit any protocol
+    // is saturated, so that it's caught by the range check later.
+    Error split(std::string_view& input) noexcept {
         auto it = input.find('/');
-        if (it != input.npos) {
-            auto cidr = input.substr(it + 1);
+        if (it == input.npos) {
+            return Error::NONE;
+        }
+
+        auto cidr = input.substr(it + 1);
+        if (cidr.empty()) {
+            return Error::BAD_PREFIX;
+        }
 
-            prefix = std::stoul(std::string(cidr));
-            nocidr = input.substr(0, it);
+        Prefix value = 0;
+        for (auto c : cidr) {
+            if (c < '0' || c > '9') {
+                return Error::BAD_PREFIX;
+            }
+            value = std::min<Prefix>(value * 10 + (c - '0'), IPv6MaxPrefix + 1);
         }
 
-        return nocidr;
+        prefix = value;
+        input = input.substr(0, it);
+
+        return Error::NONE;
     }
 
-    bool parse4(std::string_view input) {
+    template <typename View>
+    Error parse4(View input) noexcept {
         static constexpr Parser4 parser;
 
         if (prefix > IPv4MaxPrefix) {
-            throw std::invalid_argument("subnet prefix for IPv4 is out of range");
+            return Error::PREFIX_OUT_OF_RANGE;
         }
 
-        auto rc = parser.parse(input, addr);
-        if (!rc) {
-            throw std::invalid_argument("mailformed IPv4 address");
+        if (!parser.parse(input, addr)) {
+            return Error::BAD_IPV4;
         }
 
         flags |= static_cast<FlagsType>(Flags::IPV4);
         mapping4();
         masking();
 
-        return rc;
+        return Error::NONE;
     }
 
-    bool parse6(std::string_view input) {
+    template <typename View>
+    Error parse6(View input) noexcept {
         static constexpr Parser6 parser;
 
         if (prefix > IPv6MaxPrefix) {
-            throw std::invalid_argument("subnet prefix for IPv6 is out of range");
+            return Error::PREFIX_OUT_OF_RANGE;
         }
 
-        auto rc = parser.parse(input, addr);
-        if (!rc) {
-            throw std::invalid_argument("mailformed IPv6 address");
+        if (!parser.parse(input, addr)) {
+            return Error::BAD_IPV6;
         }
 
         flags |= static_cast<FlagsType>(Flags::IPV6);
         mapping6();
         masking();
 
-        return rc;
-    }
-
-    auto bitmask(Prefix value) const noexcept {
-        auto shift0 = _mm_cvtsi32_si128((int)value);
-        auto shift1 = _mm_set1_epi64x(64);
-        auto shift2 = _mm_set1_epi64x(128);
-        auto shift3 = _mm_subs_epu16(shift1, shift0);
-        auto shift4 = _mm_subs_epu16(shift2, shift0);
-
-        auto mask0 = _mm_set_epi64x(-1, 0);
-        auto mask1 = _mm_set_epi64x(0, -1);
-        auto mask2 = _mm_sll_epi64(mask0, shift3);
-        auto mask3 = _mm_sll_epi64(mask1, shift4);
-        auto mask5 = _mm_or_si128(mask2, mask3);
-
-        auto shmask = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-        return _mm_shuffle_epi8(mask5, shmask);
+        return Error::NONE;
     }
 
     void masking() noexcept {
@@ -210,6 +410,23 @@ class Subnet {
     FlagsType flags = 0;
 };
 
+// Literals are checked at compile time where consteval is supported, or when
+// they initialize constexpr variables
+#if defined(__cpp_consteval)
+#define NETADDR_CONSTEVAL consteval
+#else
+#define NETADDR_CONSTEVAL constexpr
+#endif
+
+namespace literals {
+
+// "10.0.0.0/8"_net is the same as Subnet("10.0.0.0/8")
+NETADDR_CONSTEVAL Subnet operator""_net(const char* input, std::size_t size) {
+    return Subnet::parseConst({input, size});
+}
+
+} // namespace literals
+
 } // namespace netaddr
 
 #endif
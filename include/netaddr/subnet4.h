@@ -0,0 +1,146 @@
+#pragma once
+#ifndef NETADDR_SUBNET4_H_
+#define NETADDR_SUBNET4_H_
+
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// IPv4 only subnet in 8 bytes for services which never see IPv6: the masked
+// address in host order and the prefix length. Unlike Subnet, which maps IPv4
+// to IPv6, everything is 32-bit arithmetic, and the netmask is computed from
+// the prefix length when needed. Single addresses are Address4 values in
+// network order, as in struct in_addr.
+class Subnet4 {
+  public:
+    using Prefix = Subnet::Prefix;
+
+    static constexpr Prefix MaxPrefix = Subnet::IPv4MaxPrefix;
+
+    Prefix cidr() const noexcept { return prefix; }
+
+    auto addr4() const noexcept {
+        struct in_addr value;
+        value.s_addr = htonl(addr);
+        return value;
+    }
+
+    auto mask4() const noexcept {
+        struct in_addr value;
+        value.s_addr = htonl(mask());
+        return value;
+    }
+
+    bool operator==(const Subnet4& other) const noexcept {
+        return addr == other.addr && prefix == other.prefix;
+    }
+
+    bool operator!=(const Subnet4& other) const noexcept { return !(*this == other); }
+
+    // by address, then by prefix length, the same order as of Subnet
+    bool operator<(const Subnet4& other) const noexcept {
+        return addr < other.addr || (addr == other.addr && prefix < other.prefix);
+    }
+
+    bool belongs(const Subnet4& parent) const noexcept { return parent.contains(*this); }
+
+    bool contains(const Subnet4& child) const noexcept {
+        return child.prefix >= prefix && ((child.addr ^ addr) & mask()) == 0;
+    }
+
+    // `address` is in network byte order
+    bool contains(Address4 address) const noexcept {
+        return ((ntohl(address) ^ addr) & mask()) == 0;
+    }
+
+    Subnet4() noexcept = default;
+
+    Subnet4(const char* input) : Subnet4(std::string_view{input}) {}
+
+    // Throws std::invalid_argument for malformed input and IPv6 subnets
+    Subnet4(std::string_view input) {
+        auto result = tryParse(input);
+        if (!result) {
+            throw std::invalid_argument(describe(result.error()));
+        }
+        *this = result.value();
+    }
+
+    // Throws std::invalid_argument for non IPv4 subnets
+    explicit Subnet4(const Subnet& subnet) {
+        if (!subnet.v4()) {
+            throw std::invalid_argument("IPv4 subnet is expected");
+        }
+
+        addr = ntohl(subnet.raw().data.dwords[OffsetIPv4Dword]);
+        prefix = (std::uint8_t)subnet.cidr();
+    }
+
+    // `address` is in network byte order and is masked by `length`, which
+    // must not exceed MaxPrefix
+    Subnet4(Address4 address, Prefix length) noexcept : prefix((std::uint8_t)length) {
+        addr = ntohl(address) & mask();
+    }
+
+    ~Subnet4() = default;
+
+    // Same as the constructor, but reports malformed input instead of throwing,
+    // IPv6 subnets are Error::BAD_IPV4
+    static Result<Subnet4> tryParse(std::string_view input) noexcept {
+        Address4 address, netmask;
+        std::size_t length;
+
+        if (Parser4::parseCidr(input, address, netmask, length)) {
+            return Subnet4(address, length);
+        }
+
+        // the slow path of Subnet accepts a few more spellings of prefixes and
+        // tells what's wrong with the input
+        auto result = Subnet::tryParse(input);
+        if (!result) {
+            return result.error();
+        }
+        if (!result->v4()) {
+            return Error::BAD_IPV4;
+        }
+
+        return Subnet4(*result);
+    }
+
+    Subnet subnet() const noexcept {
+        auto length = std::min<Prefix>(prefix, MaxPrefix) + Subnet::IPv4PrefixOffset;
+        return Subnet(Raw((Address4)htonl(addr)), length, Subnet::Protocol::IPV4);
+    }
+
+    // Writes text of the subnet as Subnet::toChars() does
+    char* toChars(char* output) const noexcept {
+        output = Formatter::format4(htonl(addr), output);
+        if (prefix < MaxPrefix) {
+            output = Formatter::formatPrefix(prefix, output);
+        }
+
+        return output;
+    }
+
+    std::string str() const {
+        char buf[Formatter::BufferSize];
+        return std::string(buf, toChars(buf));
+    }
+
+  private:
+    // a 64-bit shift gives no ones for the zero prefix without a branch, longer
+    // prefixes which only come from corrupt tables are taken as hosts
+    std::uint32_t mask() const noexcept {
+        auto length = std::min<Prefix>(prefix, MaxPrefix);
+        return (std::uint32_t)(~0ULL << (MaxPrefix - length));
+    }
+
+    std::uint32_t addr = 0;
+    std::uint8_t prefix = 0;
+    // explicit padding keeps tables written by BinaryFormat reproducible
+    std::uint8_t reserved[3] = {};
+};
+
+} // namespace netaddr
+
+#endif
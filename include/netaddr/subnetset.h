@@ -0,0 +1,286 @@
+#pragma once
+#ifndef NETADDR_SUBNETSET_H_
+#define NETADDR_SUBNETSET_H_
+
+#include <vector>
+
+#include <netaddr/cpu.h>
+#include <netaddr/simd.h>
+#include <netaddr/subnet.h>
+
+namespace netaddr {
+
+// A list of subnets checked against an address all at once. Halves of masked
+// addresses, halves of masks, prefixes and flags live in separate arrays, so
+// that a single instruction compares an address with several subnets: two
+// with SSE4.2, four with AVX2 and eight with AVX-512, as Cpu::level() allows.
+// Matching rules are the same as of Subnet::contains.
+class SubnetSet {
+  public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    SubnetSet() = default;
+
+    SubnetSet(const std::vector<Subnet>& subnets) {
+        for (const auto& subnet : subnets) {
+            insert(subnet);
+        }
+    }
+
+    ~SubnetSet() = default;
+
+    // Appends `subnet` to the end, indices of subnets are their insertion order
+    void insert(const Subnet& subnet) {
+        auto lane = count % Lanes;
+        if (lane == 0) {
+            addrs[0].emplace_back();
+            addrs[1].emplace_back();
+            masks[0].emplace_back();
+            masks[1].emplace_back();
+            // padding never matches: no prefix is that long and no flags are set
+            prefixes.insert(prefixes.end(), Lanes, NoPrefix);
+            flags.insert(flags.end(), Lanes, 0);
+        }
+
+        Raw mask;
+        _mm_storeu_si128((__m128i*)&mask, Subnet::bitmask(subnet.length()));
+
+        for (std::size_t i = 0; i < 2; ++i) {
+            addrs[i].back().qwords[lane] = subnet.raw().data.qwords[i];
+            masks[i].back().qwords[lane] = mask.data.qwords[i];
+        }
+        prefixes[count] = (std::uint8_t)subnet.length();
+        flags[count] = family(subnet);
+
+        ++count;
+    }
+
+    std::size_t size() const noexcept { return count; }
+
+    bool empty() const noexcept { return count == 0; }
+
+    // Index of the first subnet containing `address` or npos
+    std::size_t find(const Subnet& address) const noexcept { return find(address, 0); }
+
+    bool contains(const Subnet& address) const noexcept {
+        return find(address) != npos;
+    }
+
+    // Appends indices of all subnets containing `address` to `output` in
+    // ascending order, returns how many of them were found
+    std::size_t findAll(const Subnet& address, std::vector<std::size_t>& output) const {
+        std::size_t total = 0;
+
+        for (auto i = find(address, 0); i != npos; i = find(address, i + 1)) {
+            output.push_back(i);
+            ++total;
+        }
+
+        return total;
+    }
+
+  private:
+    static constexpr std::size_t Lanes = 4;
+    static constexpr std::uint8_t NoPrefix = 0xFF;
+
+    // Bits of the protocols matched as of Subnet::contains(): subnets of one
+    // protocol meet, and so do IPv4 and mapped IPv6 ones
+    static std::uint8_t family(const Subnet& subnet) noexcept {
+        return (subnet.v4() ? 1 : 0) | (subnet.v6() ? 2 : 0) | (subnet.mapped() ? 4 : 0);
+    }
+
+    struct alignas(32) Block {
+        std::uint64_t qwords[Lanes];
+    };
+
+    // Index of the first subnet starting from `from` containing `address`
+    std::size_t find(const Subnet& address, std::size_t from) const noexcept {
+        switch (Cpu::level()) {
+        case Cpu::Level::SCALAR:
+            return findScalar(address, from);
+        case Cpu::Level::SSE42:
+            return findSse42(address, from);
+        case Cpu::Level::AVX2:
+            return findAvx2(address, from);
+        case Cpu::Level::AVX512:
+            return findAvx512(address, from);
+        }
+
+        return npos;
+    }
+
+    // Bits of subnets of `block` starting from subnet `from`
+    static std::uint32_t lanes(std::size_t block, std::size_t from) noexcept {
+        return block == from / Lanes ? ~0U << (from % Lanes) : ~0U;
+    }
+
+    std::size_t findScalar(const Subnet& address, std::size_t from) const noexcept {
+        auto hi = address.raw().data.qwords[0];
+        auto lo = address.raw().data.qwords[1];
+        auto flag = family(address);
+
+        for (std::size_t i = from; i < count; ++i) {
+            auto block = i / Lanes, lane = i % Lanes;
+            auto maskHi = masks[0][block].qwords[lane];
+            auto maskLo = masks[1][block].qwords[lane];
+            bool eqHi = (hi & maskHi) == addrs[0][block].qwords[lane];
+            bool eqLo = (lo & maskLo) == addrs[1][block].qwords[lane];
+
+            if (eqHi && eqLo && prefixes[i] <= address.length() && (flags[i] & flag)) {
+                return i;
+            }
+        }
+
+        return npos;
+    }
+
+    // Two subnets at a time
+    std::size_t findSse42(const Subnet& address, std::size_t from) const noexcept {
+        const auto hi = _mm_set1_epi64x((long long)address.raw().data.qwords[0]);
+        const auto lo = _mm_set1_epi64x((long long)address.raw().data.qwords[1]);
+        const auto prefix = _mm_set1_epi64x((long long)address.length());
+        const auto flag = _mm_set1_epi64x(family(address));
+
+        for (std::size_t block = from / Lanes; block < addrs[0].size(); ++block) {
+            std::uint32_t matched = 0;
+
+            for (std::size_t half = 0; half < Lanes / 2; ++half) {
+                auto first = block * Lanes + half * 2;
+                auto qwords = [block, half](const std::vector<Block>& v) {
+                    return _mm_load_si128((const __m128i*)&v[block].qwords[half * 2]);
+                };
+
+                auto eqHi = _mm_cmpeq_epi64(_mm_and_si128(hi, qwords(masks[0])),
+                                            qwords(addrs[0]));
+                auto eqLo = _mm_cmpeq_epi64(_mm_and_si128(lo, qwords(masks[1])),
+                                            qwords(addrs[1]));
+                auto longer = _mm_cmpgt_epi64(bytes2(prefixes, first), prefix);
+                auto disjoint = _mm_cmpeq_epi64(_mm_and_si128(bytes2(flags, first), flag),
+                                                _mm_setzero_si128());
+
+                auto ok = _mm_andnot_si128(_mm_or_si128(longer, disjoint),
+                                           _mm_and_si128(eqHi, eqLo));
+                matched |= (std::uint32_t)_mm_movemask_pd(_mm_castsi128_pd(ok))
+                           << (half * 2);
+            }
+
+            matched &= lanes(block, from);
+            if (matched) {
+                return block * Lanes + simd::lowestBit(matched);
+            }
+        }
+
+        return npos;
+    }
+
+    // Four subnets at a time
+    NETADDR_TARGET_AVX2
+    std::size_t findAvx2(const Subnet& address, std::size_t from) const noexcept {
+        for (std::size_t block = from / Lanes; block < addrs[0].size(); ++block) {
+            auto matched = matchAvx2(address, block) & lanes(block, from);
+            if (matched) {
+                return block * Lanes + simd::lowestBit(matched);
+            }
+        }
+
+        return npos;
+    }
+
+    // Eight subnets of two blocks at a time
+    NETADDR_TARGET_AVX512
+    std::size_t findAvx512(const Subnet& address, std::size_t from) const noexcept {
+        const auto hi = _mm512_set1_epi64((long long)address.raw().data.qwords[0]);
+        const auto lo = _mm512_set1_epi64((long long)address.raw().data.qwords[1]);
+        const auto prefix = _mm512_set1_epi64((long long)address.length());
+        const auto flag = _mm512_set1_epi64(family(address));
+
+        std::size_t block = from / Lanes;
+        for (; block + 2 <= addrs[0].size(); block += 2) {
+            auto first = block * Lanes;
+
+            auto matched = _mm512_cmpeq_epi64_mask(
+                _mm512_and_si512(hi, qwords8(masks[0], block)), qwords8(addrs[0], block));
+            matched &= _mm512_cmpeq_epi64_mask(
+                _mm512_and_si512(lo, qwords8(masks[1], block)), qwords8(addrs[1], block));
+            matched &= _mm512_cmple_epu64_mask(bytes8(prefixes, first), prefix);
+            matched &= _mm512_test_epi64_mask(bytes8(flags, first), flag);
+
+            auto bits = (std::uint32_t)matched & (lanes(block, from) |
+                                                  lanes(block + 1, from) << Lanes);
+            if (bits) {
+                return first + simd::lowestBit(bits);
+            }
+        }
+
+        // an odd block is left
+        if (block < addrs[0].size()) {
+            auto matched = matchAvx2(address, block) & lanes(block, from);
+            if (matched) {
+                return block * Lanes + simd::lowestBit(matched);
+            }
+        }
+
+        return npos;
+    }
+
+    // Bit per subnet of `block` which contains `address`
+    NETADDR_TARGET_AVX2
+    std::uint32_t matchAvx2(const Subnet& address, std::size_t block) const noexcept {
+        auto hi = _mm256_set1_epi64x((long long)address.raw().data.qwords[0]);
+        auto lo = _mm256_set1_epi64x((long long)address.raw().data.qwords[1]);
+        auto prefix = _mm256_set1_epi64x((long long)address.length());
+        auto flag = _mm256_set1_epi64x(family(address));
+
+        auto maskHi = _mm256_load_si256((const __m256i*)&masks[0][block]);
+        auto maskLo = _mm256_load_si256((const __m256i*)&masks[1][block]);
+        auto addrHi = _mm256_load_si256((const __m256i*)&addrs[0][block]);
+        auto addrLo = _mm256_load_si256((const __m256i*)&addrs[1][block]);
+
+        auto eqHi = _mm256_cmpeq_epi64(_mm256_and_si256(hi, maskHi), addrHi);
+        auto eqLo = _mm256_cmpeq_epi64(_mm256_and_si256(lo, maskLo), addrLo);
+        auto longer = _mm256_cmpgt_epi64(bytes4(prefixes, block * Lanes), prefix);
+        auto disjoint = _mm256_cmpeq_epi64(
+            _mm256_and_si256(bytes4(flags, block * Lanes), flag), _mm256_setzero_si256());
+
+        auto ok = _mm256_andnot_si256(_mm256_or_si256(longer, disjoint),
+                                      _mm256_and_si256(eqHi, eqLo));
+        return (std::uint32_t)_mm256_movemask_pd(_mm256_castsi256_pd(ok));
+    }
+
+    // Bytes from `first` widened to qwords, as many as fit a vector
+    static __m128i bytes2(const std::vector<std::uint8_t>& v, std::size_t first) {
+        std::uint16_t packed;
+        memcpy(&packed, &v[first], sizeof(packed));
+        return _mm_cvtepu8_epi64(_mm_cvtsi32_si128(packed));
+    }
+
+    NETADDR_TARGET_AVX2
+    static __m256i bytes4(const std::vector<std::uint8_t>& v, std::size_t first) {
+        std::uint32_t packed;
+        memcpy(&packed, &v[first], sizeof(packed));
+        return _mm256_cvtepu8_epi64(_mm_cvtsi32_si128((int)packed));
+    }
+
+    NETADDR_TARGET_AVX512
+    static __m512i bytes8(const std::vector<std::uint8_t>& v, std::size_t first) {
+        // the masked form dodges a false -Wmaybe-uninitialized of GCC 12
+        auto packed = _mm_loadl_epi64((const __m128i*)&v[first]);
+        return _mm512_maskz_cvtepu8_epi64(0xFF, packed);
+    }
+
+    // Qwords of `block` and the next one
+    NETADDR_TARGET_AVX512
+    static __m512i qwords8(const std::vector<Block>& v, std::size_t block) {
+        return _mm512_loadu_si512((const void*)&v[block]);
+    }
+
+    std::vector<Block> addrs[2];
+    std::vector<Block> masks[2];
+    std::vector<std::uint8_t> prefixes;
+    std::vector<std::uint8_t> flags;
+    std::size_t count = 0;
+};
+
+} // namespace netaddr
+
+#endif
@@ -5,6 +5,7 @@
 #include <netaddr/address.h>
 
 using namespace netaddr;
+using namespace netaddr::literals;
 
 using TestPair = std::pair<const char*, const char*>;
 
@@ -66,11 +67,13 @@ TEST(Address, InvalidConstructors) {
         "2001db8",
         "2001::db8::1",
         "::1234:5678/64"
-        ""
-        // Boost doesn't support such format
-        // neither do we
-        // the original Ada implementation, however, can handle ::ffff:a.b.c.d
-        "::ffff:192.168.1.1"
+        "",
+        // an IPv4 address only at the end and in place of two pieces
+        "::ffff:192.168.1.1:0",
+        "::ffff:192.168.1",
+        "1:2:3:4:5:6:7:192.168.1.1",
+        "1:2:3:4:5:6::192.168.1.1",
+        "::ffff:192.168.1.1/"
     };
     // clang-format on
 
@@ -81,3 +84,39 @@ TEST(Address, InvalidConstructors) {
             << "There must be exception thrown in constructor for " << item;
     }
 }
+
+TEST(Address, TryParse) {
+    EXPECT_TRUE(Address::tryParse("10.10.10.10").ok());
+    EXPECT_TRUE(Address::tryParse("2001:db8::1234:5678").ok());
+    EXPECT_EQ(Address::tryParse("10.10.10").error(), Error::BAD_IPV4);
+    EXPECT_EQ(Address::tryParse("10.10.10.10/8").error(), Error::BAD_IPV4);
+    EXPECT_EQ(Address::tryParse("2001::db8::1").error(), Error::BAD_IPV6);
+    EXPECT_TRUE(*Address::tryParse("192.168.1.133") == Address("192.168.1.133"));
+}
+
+TEST(Address, Padded) {
+    std::string buffer = "10.10.10.10/8 2001:db8::1234:5678 10.10.10";
+    buffer.append(PaddedStringView::Padding, ' ');
+
+    PaddedStringView v4(buffer.data(), 11);
+    EXPECT_TRUE(*Address::tryParse(v4) == Address("10.10.10.10"));
+    EXPECT_EQ(Address::tryParse(PaddedStringView(buffer.data(), 13)).error(),
+              Error::BAD_IPV4);
+
+    PaddedStringView v6(buffer.data() + 14, 19);
+    EXPECT_TRUE(Address(v6) == Address("2001:db8::1234:5678"));
+    EXPECT_ANY_THROW(Address(PaddedStringView(buffer.data() + 14, 8)));
+}
+
+TEST(Address, Literals) {
+    constexpr Address loopback = "::1"_ip;
+    constexpr Address host = "192.168.1.133"_ip;
+
+    static_assert(loopback.v6() && loopback.cidr() == 128);
+    static_assert(host.v4() && host.cidr() == 32);
+
+    EXPECT_TRUE(loopback == Address("::1"));
+    EXPECT_EQ(host.dump(), Address("192.168.1.133").dump());
+    EXPECT_THROW(Address::parseConst("10.10.10.10/8"), std::invalid_argument);
+    EXPECT_THROW(Address::parseConst("2001::db8::1"), std::invalid_argument);
+}
@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include <netaddr/parser4.h>
 #include <netaddr/parser6.h>
 
@@ -76,6 +81,203 @@ TEST(Parser4, IPv4Subsr) {
     ASSERT_EQ(memcmp(&sys, &own.data.v4.in_addr, sizeof(struct in_addr)), 0);
 }
 
+TEST(Parser4, IPv4Batch) {
+    // clang-format off
+    constexpr std::string_view data[] = {
+        "1.1.1.1",
+        "a.b.c.d",
+        "2.22.99.130",
+        "255.255.255.255",
+        "999.255.255.255",
+        "127.0.0.1",
+        "10.10.10",
+        "10.10.10.10",
+        "192.168.127.1111",
+        "192.168.1.133",
+        "",
+        "200.1.1.1",
+        "0.0.0.0",
+        "255255255255",
+        "224.0.0.1"
+    };
+    // clang-format on
+    constexpr auto count = std::size(data);
+
+    // more than one bitmap word and an odd tail
+    std::vector<std::string_view> input;
+    for (std::size_t i = 0; i < 5; ++i) {
+        input.insert(input.end(), std::begin(data), std::end(data));
+    }
+
+    // every kernel the CPU has
+    auto saved = Cpu::level();
+    for (auto level : {Cpu::Level::SCALAR, Cpu::Level::SSE42, Cpu::Level::AVX2,
+                       Cpu::Level::AVX512}) {
+        if (Cpu::setLevel(level) != level) {
+            continue;
+        }
+
+        std::vector<Raw> output(input.size());
+        std::vector<std::uint64_t> bitmap((input.size() + 63) / 64);
+
+        auto total =
+            parser4.parseBatch(input.data(), input.size(), output.data(), bitmap.data());
+
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            Raw own;
+            bool rc = parser4.parse(input[i], own);
+            bool ok = (bitmap[i / 64] >> (i % 64)) & 1;
+
+            expected += rc;
+            ASSERT_EQ(ok, rc) << "parseBatch() and parse() disagree for "
+                              << data[i % count] << " with " << Cpu::describe(level);
+            if (rc) {
+                ASSERT_EQ(own, output[i])
+                    << "results from parseBatch() and parse() for " << data[i % count]
+                    << " must be the same with " << Cpu::describe(level);
+            }
+        }
+
+        ASSERT_EQ(total, expected) << Cpu::describe(level);
+    }
+    Cpu::setLevel(saved);
+}
+
+TEST(Parser4, IPv4Scalar) {
+    std::mt19937 rng(4);
+    constexpr char alphabet[] = "0123456789.0123456789.x";
+
+    for (std::size_t i = 0; i < 200000; ++i) {
+        std::string s;
+        if (i % 2) {
+            // mostly almost valid addresses
+            for (std::size_t j = 0; j < 4; ++j) {
+                s += (j ? "." : "") + std::to_string(rng() % (j == i % 4 ? 1000 : 256));
+            }
+            if (rng() % 8 == 0) {
+                s[rng() % s.size()] = alphabet[rng() % (sizeof(alphabet) - 1)];
+            }
+        } else {
+            for (std::size_t j = rng() % 17; j; --j) {
+                s += alphabet[rng() % (sizeof(alphabet) - 1)];
+            }
+        }
+
+        Raw simd, scalar;
+        bool rc = parser4.parse(s, simd);
+        ASSERT_EQ(Parser4::parseScalar(s, scalar), rc) << s;
+        if (rc) {
+            ASSERT_EQ(simd, scalar) << s;
+        }
+    }
+}
+
+TEST(Parser4, IPv4Cidr) {
+    using TestCidr = std::tuple<const char*, const char*, const char*, std::size_t>;
+
+    // clang-format off
+    const TestCidr valid[] = {
+        {"1.1.1.1", "1.1.1.1", "255.255.255.255", 32},
+        {"192.168.1.133/24", "192.168.1.0", "255.255.255.0", 24},
+        {"255.255.255.255/1", "128.0.0.0", "128.0.0.0", 1},
+        {"212.164.39.156/11", "212.160.0.0", "255.224.0.0", 11},
+        {"10.10.10.10/8", "10.0.0.0", "255.0.0.0", 8},
+        {"127.0.0.1/32", "127.0.0.1", "255.255.255.255", 32},
+        {"0.0.0.0/0", "0.0.0.0", "0.0.0.0", 0},
+        {"200.1.1.1/0", "0.0.0.0", "0.0.0.0", 0},
+    };
+
+    constexpr const char* invalid[] = {
+        "1.1.1.1/",
+        "1.1.1.1/33",
+        "1.1.1.1/99",
+        "1.1.1.1/123",
+        "1.1.1.1/a",
+        "1.1.1.1/2a",
+        "1.1.1.1/-1",
+        "1.1.1.1//1",
+        "1.1.1/24",
+        "/24",
+        "999.255.255.255/8",
+        "255.255.255.2555/8",
+        "127..0.0.1/8",
+        ""
+    };
+    // clang-format on
+
+    for (const auto& [s, addr, mask, prefix] : valid) {
+        struct in_addr sysAddr, sysMask;
+        Raw ownAddr, ownMask;
+        std::size_t ownPrefix = 0;
+
+        ASSERT_GT(inet_pton(AF_INET, addr, &sysAddr), 0);
+        ASSERT_GT(inet_pton(AF_INET, mask, &sysMask), 0);
+        ASSERT_TRUE(parser4.parseCidr(s, ownAddr, ownMask, ownPrefix))
+            << "parseCidr() for " << s << " must not fail";
+        ASSERT_EQ(ownAddr, Raw(sysAddr)) << "wrong address for " << s;
+        ASSERT_EQ(memcmp(&sysMask, &ownMask.data.v4.in_addr, sizeof(sysMask)), 0)
+            << "wrong mask for " << s;
+        ASSERT_EQ(ownMask.data.qwords[0], ~0ULL) << "mask for " << s << " must be mapped";
+        ASSERT_EQ(ownMask.data.dwords[2], ~0U) << "mask for " << s << " must be mapped";
+        ASSERT_EQ(ownPrefix, prefix) << "wrong prefix for " << s;
+    }
+
+    for (auto s : invalid) {
+        Raw addr, mask;
+        std::size_t prefix = 0;
+
+        ASSERT_FALSE(parser4.parseCidr(s, addr, mask, prefix))
+            << "parseCidr() for " << s << " must not be succsessful";
+    }
+}
+
+// Padding full of characters the parsers accept must not change the results
+static PaddedStringView pad(std::string& buffer, std::string_view text, char filler) {
+    buffer.assign(text);
+    buffer.append(PaddedStringView::Padding, filler);
+    return PaddedStringView(buffer.data(), text.size());
+}
+
+TEST(Parser4, IPv4Padded) {
+    // clang-format off
+    constexpr const char* data[] = {
+        "1.1.1.1",
+        "255.255.255.255",
+        "10.10.10.10/8",
+        "192.168.1.133/24",
+        "0.0.0.0/0",
+        "1.1.1.1/",
+        "1.1.1.1/33",
+        "1.1.1.1/123",
+        "10.10.10",
+        "999.255.255.255",
+        "192.168.127.1111",
+        ""
+    };
+    // clang-format on
+
+    std::string buffer;
+    for (auto s : data) {
+        for (auto filler : {'\0', '1', '.', '/'}) {
+            auto padded = pad(buffer, s, filler);
+            Raw expected, own;
+
+            EXPECT_EQ(parser4.parse(padded, own), parser4.parse(s, expected)) << s;
+            EXPECT_EQ(own, expected) << s;
+
+            Raw mask, expectedMask;
+            std::size_t prefix = 0, expectedPrefix = 0;
+            EXPECT_EQ(parser4.parseCidr(padded, own, mask, prefix),
+                      parser4.parseCidr(s, expected, expectedMask, expectedPrefix))
+                << s;
+            EXPECT_EQ(own, expected) << s;
+            EXPECT_EQ(mask, expectedMask) << s;
+            EXPECT_EQ(prefix, expectedPrefix) << s;
+        }
+    }
+}
+
 TEST(Parser6, IPv6Valid) {
     // clang-format off
     constexpr const char* valid[] = {
@@ -93,6 +295,12 @@ TEST(Parser6, IPv6Valid) {
         "fec0::0000:0000:aabb:dd",
         "fc00::a1:2d",
         "ff00::22",
+        "::ffff:192.0.2.1",
+        "64:ff9b::10.0.0.1",
+        "::1.2.3.4",
+        "1:2:3:4:5:6:255.255.255.255",
+        "1:2:3:4:5::0.0.0.0",
+        "::FFFF:C0A8:101",
     };
     // clang-format on
 
@@ -124,11 +332,13 @@ TEST(Parser6, IPv6Malformed) {
         "2001:db8",
         "2001db8",
         "2001::db8::1",
-        ""
-        // Boost doesn't support such format
-        // neither do we
-        // the original Ada implementation, however, can handle ::ffff:a.b.c.d
-        "::ffff:192.168.1.1"
+        "",
+        // an IPv4 address only at the end and in place of two pieces
+        "::ffff:192.168.1.1:0",
+        "::ffff:192.168.1",
+        "1:2:3:4:5:6:7:192.168.1.1",
+        "1:2:3:4:5:6::192.168.1.1",
+        "::ffff:192.168.1.1/"
     };
     // clang-format on
 
@@ -140,6 +350,38 @@ TEST(Parser6, IPv6Malformed) {
     }
 }
 
+TEST(Parser6, IPv6Padded) {
+    // clang-format off
+    constexpr const char* data[] = {
+        "2001:db8:3333:4444:5555:6666:7777:8888",
+        "2001:0db8:0001:0000:0000:0ab9:C0A8:0102",
+        "::",
+        "::1",
+        "2001:db8::",
+        "fe80::2bc6:6b94:64e6:fb7d",
+        "2001:db8:3333:4444:5555:6666:7777:8888:9999",
+        "2001:db8:",
+        "2001::db8::1",
+        "::ffff:192.0.2.1",
+        "1:2:3:4:5:6:255.255.255.255",
+        "::ffff:192.0.2",
+        ""
+    };
+    // clang-format on
+
+    std::string buffer;
+    for (auto s : data) {
+        for (auto filler : {'\0', 'f', ':', '1', '.'}) {
+            Raw expected, own;
+
+            EXPECT_EQ(parser6.parse(pad(buffer, s, filler), own),
+                      parser6.parse(s, expected))
+                << s;
+            EXPECT_EQ(own, expected) << s;
+        }
+    }
+}
+
 TEST(Parser6, IPv6Subsr) {
     std::string_view full = "Hello darkness, 32001:db8:3333:4444:5555::223 my old friend";
     std::string_view sv = full.substr(17, 27);
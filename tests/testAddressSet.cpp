@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <netaddr/addressset.h>
+
+using namespace netaddr;
+
+static Raw randomRaw(std::mt19937& rng) {
+    Raw raw;
+
+    // few distinct values, so that keys repeat
+    raw.data.dwords[0] = htonl(0x20010db8);
+    raw.data.dwords[3] = rng() % 50000;
+
+    return raw;
+}
+
+TEST(Hash, Consistency) {
+    std::hash<Subnet> hash;
+
+    EXPECT_EQ(hash(Subnet("10.1.2.3/8")), hash(Subnet("10.0.0.0/8")));
+    EXPECT_EQ(hash(Subnet("10.1.2.3")), hash(Subnet("::ffff:a01:203")))
+        << "Equal subnets must have equal hashes";
+    EXPECT_NE(hash(Subnet("10.0.0.0/8")), hash(Subnet("10.0.0.0/9")));
+    EXPECT_EQ(std::hash<Address>()(Address("2001:db8::1")),
+              hash(Subnet("2001:db8::1/128")));
+    EXPECT_NE(std::hash<Raw>()(Raw()), std::hash<Raw>()(Raw(htonl(1))));
+
+    std::unordered_set<Subnet> subnets = {"10.0.0.0/8", "10.1.0.0/8", "2001:db8::/32"};
+    EXPECT_EQ(subnets.size(), 2);
+}
+
+TEST(AddressSet, Basic) {
+    AddressSet set;
+
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Address("10.0.0.1")));
+    EXPECT_FALSE(set.erase(Address("10.0.0.1")));
+
+    EXPECT_TRUE(set.insert(Address("10.0.0.1")));
+    EXPECT_TRUE(set.insert(Address("2001:db8::1")));
+    EXPECT_FALSE(set.insert(Address("::ffff:a00:1")))
+        << "Mapped IPv6 is the same address as IPv4";
+
+    EXPECT_EQ(set.size(), 2);
+    EXPECT_TRUE(set.contains(Address("10.0.0.1")));
+    EXPECT_TRUE(set.contains(Address("2001:db8::1")));
+    EXPECT_FALSE(set.contains(Address("2001:db8::2")));
+
+    EXPECT_TRUE(set.erase(Address("10.0.0.1")));
+    EXPECT_FALSE(set.contains(Address("10.0.0.1")));
+    EXPECT_EQ(set.size(), 1);
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Address("2001:db8::1")));
+}
+
+TEST(AddressMap, RandomAgainstUnorderedMap) {
+    std::mt19937 rng(10);
+    AddressMap<std::size_t> map;
+    std::unordered_map<Raw, std::size_t> reference;
+
+    for (std::size_t i = 0; i < 200000; ++i) {
+        auto key = randomRaw(rng);
+
+        switch (rng() % 4) {
+        case 0:
+            ASSERT_EQ(map.erase(key), reference.erase(key) == 1);
+            break;
+        case 1: {
+            auto* value = map.find(key);
+            auto it = reference.find(key);
+            ASSERT_EQ(value == nullptr, it == reference.end());
+            if (value) {
+                ASSERT_EQ(*value, it->second);
+            }
+            break;
+        }
+        default: {
+            auto [value, inserted] = map.insert(key, i);
+            auto [it, expected] = reference.emplace(key, i);
+            ASSERT_EQ(inserted, expected);
+            ASSERT_EQ(*value, it->second);
+        }
+        }
+
+        ASSERT_EQ(map.size(), reference.size());
+    }
+
+    for (const auto& [key, value] : reference) {
+        ASSERT_TRUE(map.contains(key));
+        ASSERT_EQ(*map.find(key), value);
+    }
+
+    map.reserve(1000000);
+    EXPECT_GE(map.capacity(), 1000000);
+    for (const auto& [key, value] : reference) {
+        ASSERT_EQ(*map.find(key), value) << "Rehashing must keep values";
+    }
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/aggregate.h>
+
+using namespace netaddr;
+
+static std::vector<Subnet> make(std::vector<const char*> data) {
+    return std::vector<Subnet>(data.begin(), data.end());
+}
+
+TEST(Aggregate, Basic) {
+    // clang-format off
+    const std::pair<std::vector<const char*>, std::vector<const char*>> data[] = {
+        {{}, {}},
+        {{"10.0.0.0/24", "10.0.1.0/24"}, {"10.0.0.0/23"}},
+        {{"10.0.1.0/24", "10.0.2.0/24"}, {"10.0.1.0/24", "10.0.2.0/24"}},
+        {{"10.0.0.0/8", "10.1.2.3", "10.0.0.0/8"}, {"10.0.0.0/8"}},
+        {{"10.0.0.0/25", "10.0.0.128/26", "10.0.0.192/27", "10.0.0.224/27"},
+         {"10.0.0.0/24"}},
+        {{"0.0.0.0/1", "128.0.0.0/1"}, {"0.0.0.0/0"}},
+        {{"2001:db8::/33", "2001:db8:8000::/33", "2001:db8::1"}, {"2001:db8::/32"}},
+        {{"::/1", "8000::/1"}, {"::/0"}},
+        {{"0.0.0.0/0", "::/1"}, {"::/1", "0.0.0.0/0"}},
+        {{"::ffff:a00:1", "10.0.0.0/8", "::ffff:b00:1", "::ffff:b00:1"},
+         {"10.0.0.0/8", "::ffff:b00:1"}},
+        {{"::ffff:a00:0", "::ffff:a00:1"}, {"::ffff:a00:0", "::ffff:a00:1"}},
+        {{"::ffff:a00:1", "::/0"}, {"::/0"}},
+        {{"255.255.255.255", "1.1.1.1"}, {"1.1.1.1", "255.255.255.255"}},
+    };
+    // clang-format on
+
+    for (const auto& [input, expected] : data) {
+        auto subnets = make(input);
+        aggregate(subnets);
+
+        auto reference = make(expected);
+        ASSERT_EQ(subnets.size(), reference.size());
+        for (std::size_t i = 0; i < subnets.size(); ++i) {
+            EXPECT_EQ(subnets[i].dump(), reference[i].dump());
+            EXPECT_EQ(subnets[i].v4(), reference[i].v4());
+            EXPECT_EQ(subnets[i].mapped(), reference[i].mapped());
+            EXPECT_EQ(subnets[i].cidr(), reference[i].cidr());
+        }
+    }
+}
+
+TEST(Aggregate, RandomAgainstContains) {
+    std::mt19937 rng(8);
+    std::vector<Subnet> subnets;
+
+    // narrow the address space, so that subnets overlap and touch a lot
+    auto random4 = [&rng]() {
+        return "10.0." + std::to_string(rng() % 4) + "." + std::to_string(rng() % 256);
+    };
+    auto random6 = [&rng]() {
+        return "2001:db8::" + std::to_string(rng() % 4) + ":" +
+               std::to_string(rng() % 256);
+    };
+
+    for (std::size_t i = 0; i < 3000; ++i) {
+        switch (rng() % 3) {
+        case 0:
+            subnets.emplace_back(random4() + "/" + std::to_string(20 + rng() % 13));
+            break;
+        case 1:
+            subnets.emplace_back(random6() + "/" + std::to_string(110 + rng() % 19));
+            break;
+        default:
+            // mapped hosts, either within or next to the IPv4 ones
+            subnets.emplace_back(Address((rng() % 2 ? "::ffff:a00:" : "::ffff:b00:") +
+                                         std::to_string(rng() % 400)));
+        }
+    }
+
+    auto aggregated = subnets;
+    aggregate(aggregated);
+
+    EXPECT_LT(aggregated.size(), subnets.size());
+
+    for (std::size_t i = 0; i < aggregated.size(); ++i) {
+        for (std::size_t j = 0; j < aggregated.size(); ++j) {
+            ASSERT_TRUE(i == j || !aggregated[i].contains(aggregated[j]))
+                << aggregated[i].dump() << " contains " << aggregated[j].dump();
+        }
+    }
+
+    for (std::size_t i = 0; i < 5000; ++i) {
+        Address address(rng() % 2 ? random4() : random6());
+        auto contains = [&address](const Subnet& subnet) {
+            return subnet.contains(address);
+        };
+
+        ASSERT_EQ(std::any_of(subnets.begin(), subnets.end(), contains),
+                  std::any_of(aggregated.begin(), aggregated.end(), contains))
+            << address.dump();
+    }
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/binary.h>
+
+using namespace netaddr;
+
+// clang-format off
+static const std::vector<Subnet> Subnets = {
+    "0.0.0.0/0",
+    "10.0.0.0/8",
+    "10.1.2.0/24",
+    "255.255.255.255",
+    "::/0",
+    "2001:db8::/32",
+    "2001:db8::1",
+    "::ffff:a01:203",
+    Subnet(),
+};
+// clang-format on
+
+static std::string tempPath(const char* name) {
+    return testing::TempDir() + "netaddr." + name + ".bin";
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+TEST(BinaryFormat, Subnets) {
+    auto path = tempPath("subnets");
+    BinaryFormat::write(path, Subnets.data(), Subnets.size());
+
+    MappedTable<CompactSubnet> table(path);
+    ASSERT_EQ(table.size(), Subnets.size());
+    EXPECT_EQ((std::uintptr_t)table.data() % BinaryFormat::Alignment, 0);
+
+    std::size_t i = 0;
+    for (const auto& entry : table) {
+        EXPECT_EQ(entry.subnet(), Subnets[i]) << i;
+        ++i;
+    }
+
+    // moved tables keep the mapping
+    auto other = std::move(table);
+    EXPECT_EQ(table.size(), 0);
+    EXPECT_EQ(other[1].subnet(), Subnet("10.0.0.0/8"));
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryFormat, Subnets4) {
+    auto path = tempPath("subnets4");
+    std::vector<Subnet4> subnets;
+    for (const auto& subnet : Subnets) {
+        if (subnet.v4()) {
+            subnets.emplace_back(subnet);
+        }
+    }
+    BinaryFormat::write(path, subnets.data(), subnets.size());
+
+    MappedTable<Subnet4> table(path);
+    ASSERT_EQ(table.size(), subnets.size());
+    for (std::size_t i = 0; i < subnets.size(); ++i) {
+        EXPECT_EQ(table[i], subnets[i]) << i;
+        EXPECT_EQ(table[i].subnet(), Subnet(subnets[i].str())) << i;
+    }
+
+    // the packed form is a different kind
+    EXPECT_THROW(MappedTable<CompactSubnet4>{path}, std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryFormat, Values) {
+    auto path = tempPath("values");
+    std::vector<Raw> addresses;
+    std::vector<std::uint32_t> values;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        addresses.push_back(Raw(htonl(0x0A000000 + i)));
+        values.push_back(i * 7);
+    }
+
+    BinaryFormat::write(path, addresses.data(), addresses.size(), values.data());
+
+    MappedTable<Raw, std::uint32_t> table(path);
+    ASSERT_EQ(table.size(), addresses.size());
+    EXPECT_EQ((std::uintptr_t)table.values() % BinaryFormat::Alignment, 0);
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        EXPECT_EQ(table[i], addresses[i]);
+        EXPECT_EQ(table.value(i), values[i]);
+    }
+
+    // types must match the file
+    EXPECT_THROW(MappedTable<Raw>{path}, std::runtime_error);
+    EXPECT_THROW((MappedTable<Raw, std::uint64_t>{path}), std::runtime_error);
+    EXPECT_THROW((MappedTable<CompactSubnet, std::uint32_t>{path}), std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+// Entries aren't checked without the checksum, they must be safe to use anyway
+TEST(BinaryFormat, CorruptEntries) {
+    auto path = tempPath("entries");
+    Subnet4 subnet("10.1.2.3");
+    BinaryFormat::write(path, &subnet, 1, (const void*)nullptr, false);
+    auto content = readFile(path);
+
+    content[sizeof(BinaryFormat::Header) + sizeof(Address4)] = (char)200;
+    writeFile(path, content);
+
+    MappedTable<Subnet4> table(path, false);
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ(table[0].cidr(), 200);
+    EXPECT_TRUE(table[0].contains(Address4(htonl(0x0A010203))));
+    EXPECT_FALSE(table[0].contains(Address4(htonl(0x0A010202))));
+
+    std::remove(path.c_str());
+}
+
+// Offsets of sections which would wrap around when added to their sizes
+TEST(BinaryFormat, SectionOverflow) {
+    auto path = tempPath("overflow");
+    std::vector<Raw> addresses(16);
+    std::vector<std::uint32_t> values(16);
+    BinaryFormat::write(path, addresses.data(), addresses.size(), values.data(), false);
+    auto content = readFile(path);
+
+    auto patch = [&](std::size_t offset, std::uint64_t value) {
+        auto patched = content;
+        memcpy(&patched[offset], &value, sizeof(value));
+        writeFile(path, patched);
+    };
+
+    EXPECT_NO_THROW((MappedTable<Raw, std::uint32_t>{path}));
+
+    patch(offsetof(BinaryFormat::Header, values), ~0ULL - 63);
+    EXPECT_THROW((MappedTable<Raw, std::uint32_t>{path}), std::runtime_error);
+
+    patch(offsetof(BinaryFormat::Header, values), content.size() + 64);
+    EXPECT_THROW((MappedTable<Raw, std::uint32_t>{path}), std::runtime_error);
+
+    patch(offsetof(BinaryFormat::Header, entries), ~0ULL - 63);
+    EXPECT_THROW((MappedTable<Raw, std::uint32_t>{path}), std::runtime_error);
+
+    // the count times the entry size wraps around to a small number
+    patch(offsetof(BinaryFormat::Header, count), 1ULL << 60);
+    EXPECT_THROW((MappedTable<Raw, std::uint32_t>{path}), std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryFormat, Empty) {
+    auto path = tempPath("empty");
+    BinaryFormat::write(path, (const CompactSubnet4*)nullptr, 0);
+
+    MappedTable<CompactSubnet4> table(path);
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(table.begin(), table.end());
+
+    std::remove(path.c_str());
+}
+
+TEST(BinaryFormat, Corruption) {
+    auto path = tempPath("corruption");
+    BinaryFormat::write(path, Subnets.data(), Subnets.size());
+    auto content = readFile(path);
+
+    // a flipped bit of an entry is caught by the checksum only
+    auto flipped = content;
+    flipped[sizeof(BinaryFormat::Header) + 3] ^= 0x10;
+    writeFile(path, flipped);
+    EXPECT_THROW(MappedTable<CompactSubnet>{path}, std::runtime_error);
+    EXPECT_NO_THROW((MappedTable<CompactSubnet>{path, false}));
+
+    writeFile(path, content.substr(0, content.size() - 1));
+    EXPECT_THROW((MappedTable<CompactSubnet>{path, false}), std::runtime_error);
+
+    writeFile(path, content.substr(0, 10));
+    EXPECT_THROW((MappedTable<CompactSubnet>{path, false}), std::runtime_error);
+
+    auto magic = content;
+    magic[0] = 'X';
+    writeFile(path, magic);
+    EXPECT_THROW((MappedTable<CompactSubnet>{path, false}), std::runtime_error);
+
+    // the count is checked against the file size even without the checksum
+    auto count = content;
+    count[offsetof(BinaryFormat::Header, count) + 7] = 0x10;
+    writeFile(path, count);
+    EXPECT_THROW((MappedTable<CompactSubnet>{path, false}), std::runtime_error);
+
+    // files written without the checksum aren't verified
+    BinaryFormat::write(path, Subnets.data(), Subnets.size(), (const int*)nullptr, false);
+    flipped = readFile(path);
+    flipped[sizeof(BinaryFormat::Header) + 3] ^= 0x10;
+    writeFile(path, flipped);
+    EXPECT_NO_THROW(MappedTable<CompactSubnet>{path});
+
+    std::remove(path.c_str());
+    EXPECT_THROW(MappedTable<CompactSubnet>{path}, std::runtime_error);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <netaddr/bloom.h>
+
+using namespace netaddr;
+
+static Raw randomRaw(std::mt19937_64& rng) {
+    Raw raw;
+
+    raw.data.qwords[0] = rng();
+    raw.data.qwords[1] = rng();
+
+    return raw;
+}
+
+TEST(BloomFilter, Empty) {
+    BloomFilter filter(0);
+
+    EXPECT_EQ(filter.size(), 0);
+    EXPECT_GT(filter.bytes(), 0);
+    EXPECT_FALSE(filter.mayContain(Raw()));
+    EXPECT_FALSE(filter.mayContain(Address("10.0.0.1")));
+
+    bool result = true;
+    Raw raw;
+    filter.mayContain(&raw, 1, &result);
+    EXPECT_FALSE(result);
+}
+
+TEST(BloomFilter, Subnets) {
+    BloomFilter filter(100);
+
+    filter.insert(Subnet("10.0.0.0/8"));
+    filter.insert(Subnet("192.168.1.0/24"));
+    filter.insert(Subnet("2001:db8::/32"));
+    filter.insert(Address("198.51.100.7"));
+    filter.insert(Raw(Address("2001:db8:1::1").addr6()));
+
+    EXPECT_EQ(filter.size(), 5);
+
+    EXPECT_TRUE(filter.mayContain(Address("10.1.2.3")));
+    EXPECT_TRUE(filter.mayContain(Address("::ffff:10.255.255.255")))
+        << "IPv4 and mapped IPv6 are the same key";
+    EXPECT_TRUE(filter.mayContain(Address("192.168.1.200")));
+    EXPECT_TRUE(filter.mayContain(Address("2001:db8:ffff::1")));
+    EXPECT_TRUE(filter.mayContain(Address("198.51.100.7")));
+    EXPECT_TRUE(filter.mayContain(Subnet("10.20.0.0/16")))
+        << "Subnets are looked up by their first address";
+
+    // a single miss of a roomy filter is practically certain
+    EXPECT_FALSE(filter.mayContain(Address("11.0.0.1")));
+    EXPECT_FALSE(filter.mayContain(Address("2001:db9::1")));
+}
+
+TEST(BloomFilter, NoFalseNegatives) {
+    std::mt19937_64 rng(25);
+    std::vector<Raw> keys;
+    BloomFilter filter(100000, 0.001);
+
+    for (std::size_t i = 0; i < 100000; ++i) {
+        auto key = randomRaw(rng);
+        keys.push_back(key);
+
+        // a few prefix lengths of both families
+        switch (i % 4) {
+        case 0:
+            filter.insert(key);
+            break;
+        case 1:
+            filter.insert(Raw((Address4)key.data.dwords[3]));
+            keys.back() = Raw((Address4)key.data.dwords[3]);
+            break;
+        case 2: {
+            char buf[Formatter::BufferSize];
+            auto* end = Formatter::format4(key.data.dwords[3], buf);
+            end = Formatter::formatPrefix(24, end);
+            filter.insert(Subnet(std::string_view(buf, end - buf)));
+            keys.back() = Raw((Address4)key.data.dwords[3]);
+            keys.back().data.bytes[15] = (std::uint8_t)rng();
+            break;
+        }
+        default: {
+            char buf[Formatter::BufferSize];
+            auto* end = Formatter::format6(key, buf);
+            end = Formatter::formatPrefix(64, end);
+            filter.insert(Subnet(std::string_view(buf, end - buf)));
+            keys.back().data.qwords[1] = rng();
+        }
+        }
+    }
+
+    std::unique_ptr<bool[]> results(new bool[keys.size()]);
+    filter.mayContain(keys.data(), keys.size(), results.get());
+
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_TRUE(filter.mayContain(keys[i])) << keys[i].dump();
+        ASSERT_TRUE(results[i]) << keys[i].dump();
+    }
+}
+
+TEST(BloomFilter, FalsePositiveRate) {
+    constexpr std::size_t Count = 200000;
+
+    for (double rate : {0.1, 0.01, 0.001}) {
+        std::mt19937_64 rng(Count);
+        BloomFilter filter(Count, rate);
+
+        for (std::size_t i = 0; i < Count; ++i) {
+            filter.insert(randomRaw(rng));
+        }
+        EXPECT_NEAR(filter.rate(), rate, rate * 0.01);
+
+        std::size_t positives = 0;
+        for (std::size_t i = 0; i < Count; ++i) {
+            positives += filter.mayContain(randomRaw(rng));
+        }
+
+        EXPECT_LT((double)positives / Count, rate * 1.2) << rate;
+        EXPECT_GT((double)positives / Count, rate * 0.8) << rate;
+    }
+}
+
+TEST(BloomFilter, Sizing) {
+    EXPECT_GT(BloomFilter::bitsPerKey(0.001), BloomFilter::bitsPerKey(0.01));
+    EXPECT_LE(BloomFilter::falsePositiveRate(BloomFilter::bitsPerKey(0.01)), 0.01);
+    EXPECT_GT(BloomFilter::falsePositiveRate(8), BloomFilter::falsePositiveRate(16));
+
+    BloomFilter small(1000, 0.01), large(1000, 0.0001);
+    EXPECT_GT(large.bytes(), small.bytes());
+}
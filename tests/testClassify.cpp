@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <netaddr/classify.h>
+
+using namespace netaddr;
+
+using Category = Classifier::Category;
+using Categories = Classifier::Categories;
+
+static constexpr Categories bits(Category category) {
+    return static_cast<Categories>(category);
+}
+
+static constexpr Categories Bogon = bits(Category::BOGON);
+
+static Categories classify(std::string_view text) {
+    return Classifier::classify(Raw(Address(text).addr6()));
+}
+
+// Straight from the registries: categories of all ranges containing `address`,
+// BOGON as of the longest one, so nested ranges override enclosing ones
+static Categories reference(const Address& address) {
+    Categories result = 0;
+    std::size_t longest = 0;
+    bool bogon = false;
+
+    auto match = [&](const auto& ranges) {
+        for (const auto& range : ranges) {
+            Subnet subnet(range.subnet);
+            if (!subnet.contains(address)) {
+                continue;
+            }
+
+            // the top bit marks nested reachable ranges
+            result |= range.categories & ~Bogon & ~((Categories)1 << 31);
+            if (subnet.cidr() + 1 > longest) {
+                longest = subnet.cidr() + 1;
+                bogon = range.categories & Bogon;
+            }
+        }
+    };
+
+    match(Classifier::Ranges4);
+    match(Classifier::Ranges6);
+
+    return result | (bogon ? Bogon : 0);
+}
+
+TEST(Classifier, Examples) {
+    EXPECT_EQ(classify("8.8.8.8"), 0);
+    EXPECT_EQ(classify("2a00:1450::1"), 0);
+
+    EXPECT_EQ(classify("10.1.2.3"), bits(Category::PRIVATE) | Bogon);
+    EXPECT_EQ(classify("172.31.255.255"), bits(Category::PRIVATE) | Bogon);
+    EXPECT_EQ(classify("172.32.0.0"), 0);
+    EXPECT_EQ(classify("192.168.0.1"), bits(Category::PRIVATE) | Bogon);
+    EXPECT_EQ(classify("100.64.0.1"), bits(Category::SHARED) | Bogon);
+    EXPECT_EQ(classify("100.128.0.1"), 0);
+    EXPECT_EQ(classify("127.0.0.1"), bits(Category::LOOPBACK) | Bogon);
+    EXPECT_EQ(classify("169.254.1.1"), bits(Category::LINK_LOCAL) | Bogon);
+    EXPECT_EQ(classify("224.0.0.251"), bits(Category::MULTICAST) | Bogon);
+    EXPECT_EQ(classify("198.51.100.7"), bits(Category::DOCUMENTATION) | Bogon);
+    EXPECT_EQ(classify("198.19.255.255"), bits(Category::BENCHMARKING) | Bogon);
+    EXPECT_EQ(classify("240.0.0.1"), bits(Category::RESERVED) | Bogon);
+    EXPECT_EQ(classify("255.255.255.255"),
+              bits(Category::RESERVED) | bits(Category::BROADCAST) | Bogon);
+    EXPECT_EQ(classify("0.0.0.0"), bits(Category::UNSPECIFIED) | Bogon);
+
+    EXPECT_EQ(classify("192.0.0.8"), bits(Category::PROTOCOL) | Bogon);
+    EXPECT_EQ(classify("192.0.0.9"), bits(Category::PROTOCOL))
+        << "Reachable ranges nested in bogons aren't bogons";
+
+    EXPECT_EQ(classify("::"), bits(Category::UNSPECIFIED) | Bogon);
+    EXPECT_EQ(classify("::1"), bits(Category::LOOPBACK) | Bogon);
+    EXPECT_EQ(classify("::2"), 0);
+    EXPECT_EQ(classify("fe80::1"), bits(Category::LINK_LOCAL) | Bogon);
+    EXPECT_EQ(classify("fd00::1"), bits(Category::UNIQUE_LOCAL) | Bogon);
+    EXPECT_EQ(classify("ff02::1"), bits(Category::MULTICAST) | Bogon);
+    EXPECT_EQ(classify("2001:db8::1"), bits(Category::DOCUMENTATION) | Bogon);
+    EXPECT_EQ(classify("3fff:fff::1"), bits(Category::DOCUMENTATION) | Bogon);
+    EXPECT_EQ(classify("3fff:1000::1"), 0);
+    EXPECT_EQ(classify("64:ff9b::8.8.8.8"), bits(Category::TRANSITION));
+    EXPECT_EQ(classify("100::1"), bits(Category::DISCARD) | Bogon);
+    EXPECT_EQ(classify("2001:1::4"), bits(Category::PROTOCOL) | Bogon);
+    EXPECT_EQ(classify("2001:1::1"), bits(Category::PROTOCOL));
+    EXPECT_EQ(classify("2001::1"), bits(Category::PROTOCOL) | bits(Category::TRANSITION));
+}
+
+TEST(Classifier, Mapped) {
+    EXPECT_EQ(classify("::ffff:10.1.2.3"), classify("10.1.2.3"));
+    EXPECT_EQ(classify("::ffff:8.8.8.8"), 0);
+    EXPECT_EQ(classify("::ffff:0.0.0.0"), bits(Category::UNSPECIFIED) | Bogon);
+
+    // IPv4 ranges don't apply to IPv4 embedded otherwise
+    EXPECT_EQ(classify("::10.1.2.3"), 0);
+    EXPECT_EQ(classify("64:ff9b::10.1.2.3"), bits(Category::TRANSITION));
+}
+
+TEST(Classifier, Subnet) {
+    EXPECT_EQ(Classifier::classify(Subnet("10.0.0.0/8")), classify("10.0.0.0"));
+    EXPECT_EQ(Classifier::classify(Address("::ffff:127.0.0.1")), classify("127.0.0.1"));
+    EXPECT_EQ(Classifier::classify(Subnet("fe80::/64")), classify("fe80::"));
+    EXPECT_EQ(Classifier::classify(Subnet("::ffff:0:0/96")), classify("0.0.0.0"));
+}
+
+TEST(Classifier, Has) {
+    auto categories = classify("10.0.0.1");
+
+    EXPECT_TRUE(Classifier::has(categories, Category::PRIVATE));
+    EXPECT_TRUE(Classifier::has(categories, Category::BOGON));
+    EXPECT_FALSE(Classifier::has(categories, Category::LOOPBACK));
+    EXPECT_STREQ(Classifier::describe(Category::LINK_LOCAL), "link-local");
+}
+
+TEST(Classifier, AgainstContains) {
+    std::mt19937_64 rng(24);
+    std::vector<Address> addresses;
+
+    // edges of every range, with neighbours for IPv4
+    for (const auto& range : Classifier::Ranges4) {
+        Address4 first = Subnet(range.subnet).addr4().s_addr;
+        Address4 last = first | ~Subnet(range.subnet).mask4().s_addr;
+
+        for (auto host : {ntohl(first) - 1, ntohl(first), ntohl(last), ntohl(last) + 1}) {
+            char buf[Formatter::BufferSize];
+            addresses.emplace_back(
+                std::string_view(buf, Formatter::format4(htonl(host), buf) - buf));
+        }
+    }
+
+    for (const auto& range : Classifier::Ranges6) {
+        Subnet subnet(range.subnet);
+        Raw first(subnet.addr6());
+        Raw last(first);
+        auto mask = subnet.mask6();
+
+        for (std::size_t i = 0; i < SizeIPv6; ++i) {
+            last.data.bytes[i] |= (std::uint8_t)~mask.s6_addr[i];
+        }
+
+        for (const auto& raw : {first, last}) {
+            char buf[Formatter::BufferSize];
+            addresses.emplace_back(
+                std::string_view(buf, Formatter::format6(raw, buf) - buf));
+        }
+    }
+
+    for (std::size_t i = 0; i < 10000; ++i) {
+        char buf[Formatter::BufferSize];
+        Raw raw;
+        raw.data.qwords[0] = rng();
+        raw.data.qwords[1] = rng();
+
+        if (i % 2) {
+            addresses.emplace_back(std::string_view(
+                buf, Formatter::format4(raw.data.dwords[0], buf) - buf));
+        } else {
+            addresses.emplace_back(
+                std::string_view(buf, Formatter::format6(raw, buf) - buf));
+        }
+    }
+
+    std::vector<Raw> raws;
+    for (const auto& address : addresses) {
+        raws.emplace_back(address.addr6());
+    }
+
+    std::vector<Categories> batch(raws.size());
+    Classifier::classify(raws.data(), raws.size(), batch.data());
+
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        auto expected = reference(addresses[i]);
+
+        ASSERT_EQ(Classifier::classify(raws[i]), expected) << addresses[i].str();
+        ASSERT_EQ(Classifier::classify(addresses[i]), expected) << addresses[i].str();
+        ASSERT_EQ(batch[i], expected) << addresses[i].str();
+    }
+}
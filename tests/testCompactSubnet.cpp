@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/compactsubnet.h>
+
+using namespace netaddr;
+
+// clang-format off
+static const std::vector<Subnet> Subnets = {
+    "0.0.0.0/0",
+    "10.0.0.0/8",
+    "10.1.2.0/24",
+    "10.1.2.3",
+    "255.255.255.255",
+    "::/0",
+    "2001:db8::/32",
+    "2001:db8::1/64",
+    "2001:db8::1",
+    "::ffff:0:0/95",
+    "::ffff:a01:203",
+    "::ffff:a01:200/120",
+    "::1",
+    Subnet(),
+};
+// clang-format on
+
+TEST(CompactSubnet, Size) {
+    EXPECT_EQ(sizeof(CompactSubnet), 17);
+    EXPECT_EQ(alignof(CompactSubnet), 1);
+    EXPECT_EQ(sizeof(CompactSubnet4), 5);
+}
+
+TEST(CompactSubnet, Conversion) {
+    for (const auto& subnet : Subnets) {
+        CompactSubnet compact(subnet);
+        auto restored = compact.subnet();
+
+        EXPECT_EQ(restored.dump(), subnet.dump());
+        EXPECT_EQ(restored.v4(), subnet.v4());
+        EXPECT_EQ(restored.v6(), subnet.v6());
+        EXPECT_EQ(restored.mapped(), subnet.mapped());
+        EXPECT_EQ(restored.empty(), const_cast<Subnet&>(subnet).empty());
+
+        EXPECT_EQ(compact.v4(), subnet.v4());
+        EXPECT_EQ(compact.v6(), subnet.v6());
+        EXPECT_EQ(compact.mapped(), subnet.mapped());
+        if (!compact.empty()) {
+            EXPECT_EQ(compact.cidr(), subnet.cidr());
+        }
+    }
+}
+
+TEST(CompactSubnet, Contains) {
+    for (const auto& parent : Subnets) {
+        for (const auto& child : Subnets) {
+            CompactSubnet compactParent(parent), compactChild(child);
+
+            EXPECT_EQ(compactParent.contains(compactChild), parent.contains(child))
+                << parent.dump() << " and " << child.dump();
+            EXPECT_EQ(compactChild.belongs(compactParent), child.belongs(parent))
+                << child.dump() << " and " << parent.dump();
+            EXPECT_EQ(compactParent == compactChild, &parent == &child);
+        }
+    }
+}
+
+TEST(CompactSubnet4, ConversionAndContains) {
+    std::vector<Subnet> subnets;
+    for (const auto& subnet : Subnets) {
+        if (subnet.v4()) {
+            subnets.push_back(subnet);
+        }
+    }
+
+    for (const auto& parent : subnets) {
+        CompactSubnet4 compactParent(parent);
+        EXPECT_EQ(compactParent.subnet().dump(), parent.dump());
+        EXPECT_EQ(compactParent.cidr(), parent.cidr());
+        EXPECT_EQ(compactParent.addr4().s_addr, parent.addr4().s_addr);
+        EXPECT_EQ(compactParent.subnet4(), Subnet4(parent));
+        EXPECT_EQ(CompactSubnet4(Subnet4(parent)), compactParent);
+
+        for (const auto& child : subnets) {
+            CompactSubnet4 compactChild(child);
+
+            EXPECT_EQ(compactParent.contains(compactChild), parent.contains(child));
+            EXPECT_EQ(compactChild.belongs(compactParent), child.belongs(parent));
+        }
+    }
+
+    EXPECT_ANY_THROW(CompactSubnet4(Subnet("2001:db8::/32")));
+    EXPECT_ANY_THROW(CompactSubnet4(Subnet("::ffff:a01:203")));
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+
+#include <netaddr/cpu.h>
+
+using namespace netaddr;
+
+TEST(Cpu, Names) {
+    for (auto level : {Cpu::Level::SCALAR, Cpu::Level::SSE42, Cpu::Level::AVX2,
+                       Cpu::Level::AVX512}) {
+        EXPECT_EQ(Cpu::parse(Cpu::describe(level), Cpu::Level::SSE42), level);
+    }
+
+    EXPECT_EQ(Cpu::parse("avx", Cpu::Level::SSE42), Cpu::Level::SSE42);
+    EXPECT_EQ(Cpu::parse("", Cpu::Level::AVX2), Cpu::Level::AVX2);
+}
+
+TEST(Cpu, Levels) {
+    auto saved = Cpu::level();
+
+    // SSE4.2 is the baseline of the build
+    EXPECT_GE(Cpu::supported(), Cpu::Level::SSE42);
+    EXPECT_LE(Cpu::level(), Cpu::supported());
+
+    EXPECT_EQ(Cpu::setLevel(Cpu::Level::SCALAR), Cpu::Level::SCALAR);
+    EXPECT_EQ(Cpu::level(), Cpu::Level::SCALAR);
+
+    // never above what the CPU has
+    EXPECT_EQ(Cpu::setLevel(Cpu::Level::AVX512), Cpu::supported());
+    EXPECT_EQ(Cpu::level(), Cpu::supported());
+
+    Cpu::setLevel(saved);
+}
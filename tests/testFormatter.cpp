@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/formatter.h>
+
+using namespace netaddr;
+
+static std::string text(const Raw& raw) {
+    char buf[Formatter::BufferSize];
+    return std::string(buf, toChars(raw, buf));
+}
+
+TEST(Formatter, Subnet) {
+    // clang-format off
+    const std::pair<const char*, const char*> data[] = {
+        {"1.1.1.1", "1.1.1.1"},
+        {"255.255.255.255", "255.255.255.255"},
+        {"0.0.0.0/0", "0.0.0.0/0"},
+        {"10.10.10.10/8", "10.0.0.0/8"},
+        {"192.168.100.9/32", "192.168.100.9"},
+        {"::", "::"},
+        {"::/0", "::/0"},
+        {"::1", "::1"},
+        {"1::", "1::"},
+        {"2001:DB8::1", "2001:db8::1"},
+        {"2001:db8:0:0:1:0:0:1", "2001:db8::1:0:0:1"},
+        {"2001:0:0:1:0:0:0:1", "2001:0:0:1::1"},
+        {"2001:db8:0:1:1:1:1:1", "2001:db8:0:1:1:1:1:1"},
+        {"2001:db8::/32", "2001:db8::/32"},
+        {"2001:db8:3333:4444:5555:6666:7777:8888",
+         "2001:db8:3333:4444:5555:6666:7777:8888"},
+        {"ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff/127",
+         "ffff:ffff:ffff:ffff:ffff:ffff:ffff:fffe/127"},
+        {"::ffff:a01:203", "::ffff:10.1.2.3"},
+        {"::ffff:0:0/95", "::fffe:0:0/95"},
+        {"0:1:0:0:1:0:0:0", "0:1:0:0:1::"},
+    };
+    // clang-format on
+
+    for (auto [input, expected] : data) {
+        EXPECT_EQ(Subnet(input).str(), expected);
+    }
+
+    EXPECT_EQ(Subnet().str(), "");
+    EXPECT_EQ(Address("10.1.2.3").str(), "10.1.2.3");
+}
+
+TEST(Formatter, RandomAgainstInetNtop) {
+    std::mt19937 rng(11);
+
+    for (std::size_t i = 0; i < 100000; ++i) {
+        Raw raw;
+        for (std::size_t j = 0; j < Raw().data.words.size(); ++j) {
+            // many zero pieces, so that runs of them vary
+            raw.data.words[j] = (rng() % 2) ? 0 : (std::uint16_t)(rng() >> (rng() % 16));
+        }
+
+        char expected[INET6_ADDRSTRLEN];
+        inet_ntop(AF_INET6, &raw.data, expected, sizeof(expected));
+        // inet_ntop writes IPv4 compatible addresses with a dotted suffix
+        if (std::string_view(expected).find('.') == std::string_view::npos) {
+            ASSERT_EQ(text(raw), expected);
+        }
+
+        raw.data.qwords[0] = 0;
+        raw.data.dwords[2] = htonl(0xFFFF);
+        inet_ntop(AF_INET, &raw.data.dwords[3], expected, sizeof(expected));
+        ASSERT_EQ(text(raw), expected) << "Mapped addresses are dotted quads";
+    }
+}
+
+TEST(Formatter, Batch) {
+    const std::vector<Raw> input = {Address("10.0.0.1").addr6(), Address("::1").addr6(),
+                                    Address("2001:db8::").addr6()};
+
+    std::vector<char> buf(input.size() * Formatter::BufferSize);
+    auto* end = toChars(input.data(), input.size(), buf.data());
+
+    EXPECT_EQ(std::string(buf.data(), end), "10.0.0.1\n::1\n2001:db8::\n");
+}
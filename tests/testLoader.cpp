@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include <netaddr/loader.h>
+
+using namespace netaddr;
+
+using LineError = SubnetLoader::LineError;
+
+TEST(SubnetLoader, Lines) {
+    auto loaded = SubnetLoader::loadText("# comment\n"
+                                         "10.0.0.0/8\r\n"
+                                         "\n"
+                                         "10.0.0.0/33\n"
+                                         "2001:db8::/32\n"
+                                         "bad\n"
+                                         "192.168.0.1");
+
+    std::vector<Subnet> subnets = {"10.0.0.0/8", "2001:db8::/32", "192.168.0.1"};
+    std::vector<LineError> errors = {
+        {4, Error::PREFIX_OUT_OF_RANGE},
+        {6, Error::BAD_IPV6},
+    };
+    EXPECT_EQ(loaded.subnets, subnets);
+    EXPECT_EQ(loaded.errors, errors);
+
+    EXPECT_TRUE(SubnetLoader::loadText("").subnets.empty());
+    EXPECT_TRUE(SubnetLoader::loadText("\n\n").errors.empty());
+}
+
+// the same result whatever the number of threads is
+TEST(SubnetLoader, Threads) {
+    std::mt19937 rng(17);
+    std::string text;
+    std::vector<Subnet> subnets;
+    std::vector<LineError> errors;
+
+    for (std::size_t line = 1; text.size() < 1 << 20; ++line) {
+        auto value = rng();
+        auto subnet = std::to_string(value >> 24) + "." + std::to_string(value & 0xFF) +
+                      ".0.0/" + std::to_string(value % 40);
+
+        auto result = Subnet::tryParse(subnet);
+        if (result) {
+            subnets.push_back(result.value());
+        } else {
+            errors.push_back({line, result.error()});
+        }
+        text += subnet + '\n';
+    }
+
+    for (std::size_t threads : {1, 2, 3, 8, 64}) {
+        auto loaded = SubnetLoader::loadText(text, threads);
+        EXPECT_EQ(loaded.subnets, subnets) << threads;
+        EXPECT_EQ(loaded.errors, errors) << threads;
+    }
+}
+
+TEST(SubnetLoader, File) {
+    auto path = testing::TempDir() + "netaddr.loader.txt";
+    std::ofstream(path) << "10.0.0.0/8\n::1\nx\n";
+
+    auto loaded = loadSubnets(path, 2);
+    std::vector<Subnet> subnets = {"10.0.0.0/8", "::1"};
+    EXPECT_EQ(loaded.subnets, subnets);
+    ASSERT_EQ(loaded.errors.size(), 1);
+    EXPECT_EQ(loaded.errors[0].line, 3);
+
+    std::ofstream(path, std::ios::trunc).close();
+    EXPECT_TRUE(loadSubnets(path).subnets.empty());
+
+    std::remove(path.c_str());
+    EXPECT_THROW(loadSubnets(path), std::runtime_error);
+}
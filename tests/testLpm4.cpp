@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/lpm4.h>
+
+using namespace netaddr;
+
+TEST(Lpm4, LongestPrefix) {
+    // clang-format off
+    const std::vector<Lpm4<int>::Route> routes = {
+        {"0.0.0.0/0", 0},
+        {"10.0.0.0/8", 8},
+        {"10.1.0.0/16", 16},
+        {"10.1.2.0/24", 24},
+        {"10.1.2.128/25", 25},
+        {"10.1.2.130/32", 32},
+        {"192.168.0.0/16", 160},
+        {"::ffff:ac10:1", 172},
+    };
+    // clang-format on
+
+    const std::pair<const char*, int> data[] = {
+        {"1.2.3.4", 0},          {"10.200.0.1", 8},    {"10.1.200.1", 16},
+        {"10.1.2.3", 24},        {"10.1.2.200", 25},   {"10.1.2.130", 32},
+        {"10.1.2.131", 25},      {"192.168.4.4", 160}, {"::ffff:a01:203", 24},
+        {"172.16.0.1", 172},     {"172.16.0.2", 0},
+    };
+
+    Lpm4<int> lpm(routes);
+
+    for (auto item : data) {
+        auto* value = lpm.lookup(Address(item.first));
+
+        ASSERT_NE(value, nullptr) << "There must be a route for " << item.first;
+        EXPECT_EQ(*value, item.second) << "Wrong route for " << item.first;
+    }
+
+    EXPECT_EQ(lpm.lookup(Address("2a02:6b8::1")), nullptr)
+        << "IPv6 addresses can't match IPv4 routes";
+    EXPECT_ANY_THROW(Lpm4<int>({{"2a02:6b8::/32", 1}}))
+        << "IPv6 subnets can't be added to Lpm4";
+}
+
+TEST(Lpm4, NoRoute) {
+    Lpm4<int> lpm({{"10.0.0.0/8", 1}, {"10.1.2.0/25", 2}});
+
+    EXPECT_EQ(lpm.lookup(Address("11.0.0.1")), nullptr);
+    EXPECT_EQ(lpm.lookup(Address("10.1.2.200")), lpm.lookup(Address("10.0.0.1")));
+    EXPECT_EQ(*lpm.lookup(Address("10.1.2.1")), 2);
+}
+
+TEST(Lpm4, RandomAgainstLinearScan) {
+    std::mt19937 rng(24);
+    std::vector<Lpm4<std::size_t>::Route> routes;
+
+    // narrow the address space, so that routes overlap a lot
+    auto random = [&rng]() {
+        return std::to_string(10 + rng() % 2) + "." + std::to_string(rng() % 4) + "." +
+               std::to_string(rng() % 256) + "." + std::to_string(rng() % 256);
+    };
+
+    for (std::size_t i = 0; i < 2000; ++i) {
+        auto prefix = 8 + rng() % 25;
+        routes.emplace_back(Subnet(random() + "/" + std::to_string(prefix)), i);
+    }
+
+    Lpm4<std::size_t> lpm(routes);
+
+    std::vector<Address> addresses;
+    std::vector<Address4> raw;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        addresses.emplace_back(random());
+        raw.push_back(addresses.back().addr4().s_addr);
+    }
+
+    std::vector<const std::size_t*> results(raw.size());
+    lpm.lookup(raw.data(), raw.size(), results.data());
+
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+        const auto& address = addresses[i];
+        const std::size_t* expected = nullptr;
+        std::size_t best = 0;
+
+        for (const auto& route : routes) {
+            // the last one of equal subnets wins
+            if (route.first.contains(address) && route.first.cidr() >= best) {
+                best = route.first.cidr();
+                expected = &route.second;
+            }
+        }
+
+        auto* value = lpm.lookup(address);
+        ASSERT_EQ(value == nullptr, expected == nullptr);
+        if (expected) {
+            ASSERT_EQ(*value, *expected);
+        }
+        ASSERT_EQ(results[i], value) << "Batch and single lookups must be the same";
+    }
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/lpm6.h>
+
+using namespace netaddr;
+
+TEST(Lpm6, LongestPrefix) {
+    // clang-format off
+    const std::vector<Lpm6<int>::Route> routes = {
+        {"::/0", 0},
+        {"2a02::/16", 16},
+        {"2a02:6b8::/32", 32},
+        {"2a02:6b8:0:1::/64", 64},
+        {"2a02:6b8:0:1::/65", 65},
+        {"2a02:6b8:0:1::1/128", 128},
+        {"2a02:6b8:0:1::2/127", 127},
+        {"2001:db8::/33", 33},
+        {"10.0.0.0/8", 8},
+        {"10.1.2.0/24", 24},
+    };
+    // clang-format on
+
+    const std::pair<const char*, int> data[] = {
+        {"2001::1", 0},
+        {"2a02:ffff::1", 16},
+        {"2a02:6b8:1::1", 32},
+        {"2a02:6b8:0:1:8000::1", 64},
+        {"2a02:6b8:0:1::5", 65},
+        {"2a02:6b8:0:1::1", 128},
+        {"2a02:6b8:0:1::3", 127},
+        {"2a02:6b8:0:1::4", 65},
+        {"2001:db8:7fff::1", 33},
+        {"2001:db8:8000::1", 0},
+        {"10.200.0.1", 8},
+        {"10.1.2.3", 24},
+        {"::ffff:a01:203", 24},
+        {"11.0.0.1", 0},
+    };
+
+    Lpm6<int> lpm(routes);
+
+    for (auto item : data) {
+        auto* value = lpm.lookup(Address(item.first));
+
+        ASSERT_NE(value, nullptr) << "There must be a route for " << item.first;
+        EXPECT_EQ(*value, item.second) << "Wrong route for " << item.first;
+    }
+}
+
+TEST(Lpm6, NoRoute) {
+    Lpm6<int> empty;
+    EXPECT_EQ(empty.lookup(Address("2a02:6b8::1")), nullptr);
+
+    Lpm6<int> lpm({{"2a02:6b8::/32", 1}, {"2a02:6b8::/48", 2}, {"2a02:6b8::/48", 3}});
+
+    EXPECT_EQ(lpm.lookup(Address("2a02:6b9::1")), nullptr);
+    EXPECT_EQ(lpm.lookup(Address("10.0.0.1")), nullptr);
+    EXPECT_EQ(*lpm.lookup(Address("2a02:6b8:1::1")), 1);
+    EXPECT_EQ(*lpm.lookup(Address("2a02:6b8::1")), 3) << "The last equal subnet wins";
+}
+
+TEST(Lpm6, RandomAgainstLinearScan) {
+    std::mt19937 rng(26);
+    std::vector<Lpm6<std::size_t>::Route> routes;
+
+    // narrow the address space, so that routes overlap a lot, and keep some
+    // random bits at the very end to reach the deepest nodes
+    auto random = [&rng]() {
+        char buf[INET6_ADDRSTRLEN];
+        struct in6_addr addr = {};
+
+        addr.s6_addr[0] = 0x20;
+        addr.s6_addr[1] = 0x01;
+        addr.s6_addr[2] = rng() % 2;
+        addr.s6_addr[3] = rng() % 4;
+        addr.s6_addr[4] = rng();
+        addr.s6_addr[8] = rng() % 2;
+        addr.s6_addr[15] = rng() % 4;
+
+        inet_ntop(AF_INET6, &addr, buf, sizeof(buf));
+        return std::string(buf);
+    };
+
+    for (std::size_t i = 0; i < 3000; ++i) {
+        auto prefix = 16 + rng() % 113;
+        routes.emplace_back(Subnet(random() + "/" + std::to_string(prefix)), i);
+    }
+
+    Lpm6<std::size_t> lpm(routes);
+
+    for (std::size_t i = 0; i < 5000; ++i) {
+        Address address(random());
+        const std::size_t* expected = nullptr;
+        std::size_t best = 0;
+
+        for (const auto& route : routes) {
+            // the last one of equal subnets wins
+            if (route.first.contains(address) && route.first.cidr() >= best) {
+                best = route.first.cidr();
+                expected = &route.second;
+            }
+        }
+
+        auto* value = lpm.lookup(address);
+        ASSERT_EQ(value == nullptr, expected == nullptr);
+        if (expected) {
+            ASSERT_EQ(*value, *expected) << "Wrong route for " << address.dump();
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <netaddr/parallel.h>
+
+using namespace netaddr;
+
+TEST(Parallel, Threads) {
+    EXPECT_EQ(parallel::threads(4, 1000, 100), 4);
+    EXPECT_EQ(parallel::threads(4, 250, 100), 2);
+    EXPECT_EQ(parallel::threads(4, 10, 100), 1);
+    EXPECT_EQ(parallel::threads(0, 0, 100), 1);
+    EXPECT_GE(parallel::threads(0, 1000000, 1), 1);
+}
+
+TEST(Parallel, Run) {
+    std::vector<std::atomic<int>> runs(8);
+    parallel::run(runs.size(), [&runs](std::size_t i) { ++runs[i]; });
+
+    for (const auto& count : runs) {
+        EXPECT_EQ(count.load(), 1);
+    }
+
+    parallel::run(0, [](std::size_t) { FAIL(); });
+}
+
+TEST(Parallel, FirstTaskThrows) {
+    std::atomic<int> finished{0};
+
+    // workers are joined rather than destroyed while joinable
+    auto task = [&finished](std::size_t i) {
+        if (i == 0) {
+            throw std::runtime_error("first");
+        }
+        ++finished;
+    };
+    EXPECT_THROW(parallel::run(4, task), std::runtime_error);
+    EXPECT_EQ(finished.load(), 3);
+}
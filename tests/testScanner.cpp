@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/scanner.h>
+
+using namespace netaddr;
+
+using Matches = std::vector<AddressScanner::Match>;
+
+static std::vector<std::string> texts(std::string_view text, const Matches& matches) {
+    std::vector<std::string> v;
+    for (const auto& match : matches) {
+        v.emplace_back(text.substr(match.offset, match.length));
+    }
+    return v;
+}
+
+static void expectSame(const Matches& lhs, const Matches& rhs, const std::string& what) {
+    ASSERT_EQ(lhs.size(), rhs.size()) << what;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        ASSERT_EQ(lhs[i].offset, rhs[i].offset) << what;
+        ASSERT_EQ(lhs[i].length, rhs[i].length) << what;
+        ASSERT_EQ(lhs[i].address, rhs[i].address) << what;
+    }
+}
+
+TEST(AddressScanner, Scan) {
+    constexpr std::string_view text =
+        "2024-05-01T12:34:56.789Z src=10.1.2.3:51234 dst=2a02:6b8::1 via fe80::1%eth0, "
+        "gw 192.168.0.1. dns [2001:db8::53]:53 bad=999.1.1.1 hex=deadbeef "
+        "mapped=::ffff:a01:203 10.0.0.1";
+
+    Matches matches;
+    EXPECT_EQ(AddressScanner::scan(text, matches), 7);
+
+    std::vector<std::string> expected = {
+        "10.1.2.3",     "2a02:6b8::1",    "fe80::1",  "192.168.0.1",
+        "2001:db8::53", "::ffff:a01:203", "10.0.0.1",
+    };
+    EXPECT_EQ(texts(text, matches), expected);
+
+    EXPECT_EQ(matches[0].address, Raw(Address4(htonl(0x0A010203))));
+    EXPECT_EQ(matches[1].address.dump(), "2A0206B8000000000000000000000001");
+}
+
+TEST(AddressScanner, Edges) {
+    Matches matches;
+
+    EXPECT_EQ(AddressScanner::scan("", matches), 0);
+    EXPECT_EQ(AddressScanner::scan("::", matches), 1);
+    EXPECT_EQ(AddressScanner::scan("1.2.3.4", matches), 1);
+    EXPECT_EQ(AddressScanner::scan("12:34:56 1.2.3 a.b.c.d", matches), 0);
+    EXPECT_EQ(AddressScanner::scan(std::string(100, '1') + " 1.2.3.4", matches), 1);
+    EXPECT_EQ(matches.back().offset, 101);
+}
+
+TEST(AddressScanner, Labels) {
+    constexpr std::string_view text =
+        "src:10.0.0.1 dst:10.0.0.2 ip:1.2.3.4 host:2001:db8::1 x beef:5.6.7.8 "
+        "peer:10.0.0.3:443";
+
+    Matches matches;
+    EXPECT_EQ(AddressScanner::scan(text, matches), 6);
+
+    std::vector<std::string> expected = {
+        "10.0.0.1", "10.0.0.2", "1.2.3.4", "2001:db8::1", "5.6.7.8", "10.0.0.3",
+    };
+    EXPECT_EQ(texts(text, matches), expected);
+    EXPECT_EQ(matches[4].address, Raw(Address4(htonl(0x05060708))));
+
+    matches.clear();
+    EXPECT_EQ(AddressScanner::scan("at 12:34:56.789 cafe:1.2.3", matches), 0);
+}
+
+// the same matches however text is split into chunks and whatever kernels do
+TEST(AddressScanner, Chunks) {
+    std::mt19937 rng(15);
+    constexpr std::string_view words[] = {
+        "10.1.2.3", "2a02:6b8::1", ":", ".", " ", "\n", "deadbeef", "1.2", "::",
+        "255.255.255.255", "1:2:3:4:5:6:7:8", "12:34:56", "x", "0", "abc",
+    };
+
+    std::string text;
+    while (text.size() < 20000) {
+        text += words[rng() % std::size(words)];
+    }
+
+    Matches expected;
+    auto saved = Cpu::level();
+    Cpu::setLevel(Cpu::Level::SCALAR);
+    AddressScanner::scan(text, expected);
+    EXPECT_GT(expected.size(), 50);
+
+    for (auto level : {Cpu::Level::SCALAR, Cpu::Level::SSE42, Cpu::Level::AVX2,
+                       Cpu::Level::AVX512}) {
+        if (Cpu::setLevel(level) != level) {
+            continue;
+        }
+
+        Matches matches;
+        AddressScanner::scan(text, matches);
+        expectSame(matches, expected, Cpu::describe(level));
+
+        for (std::size_t maxChunk : {1, 2, 7, 64, 100, 5000}) {
+            AddressScanner scanner;
+            Matches chunked;
+
+            for (std::size_t pos = 0; pos < text.size();) {
+                auto size = 1 + rng() % maxChunk;
+                scanner.feed(std::string_view(text).substr(pos, size), chunked);
+                pos += size;
+            }
+            scanner.finish(chunked);
+
+            auto what = std::string(Cpu::describe(level)) + " ";
+            expectSame(chunked, expected, what + std::to_string(maxChunk));
+        }
+    }
+
+    Cpu::setLevel(saved);
+}
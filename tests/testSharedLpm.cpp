@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/sharedlpm.h>
+
+using namespace netaddr;
+
+TEST(SharedLpm, Update) {
+    SharedLpm<int> table({{"10.0.0.0/8", 8}, {"10.1.0.0/16", 16}, {"10.0.0.0/8", 9}});
+    auto reader = table.reader();
+    int value = 0;
+
+    EXPECT_TRUE(reader.lookup(Address("10.1.2.3"), value));
+    EXPECT_EQ(value, 16);
+    EXPECT_TRUE(reader.lookup(Address("10.2.2.3"), value));
+    EXPECT_EQ(value, 9);
+    EXPECT_FALSE(reader.lookup(Address("2001:db8::1"), value));
+
+    EXPECT_EQ(
+        table.update({{"2001:db8::/32", 32}, {"10.0.0.0/8", 10}}, {"10.1.0.0/16"}), 1);
+    EXPECT_TRUE(reader.lookup(Address("10.1.2.3"), value));
+    EXPECT_EQ(value, 10);
+    EXPECT_TRUE(reader.lookup(Address("2001:db8::1"), value));
+    EXPECT_EQ(value, 32);
+
+    // a removed route added back in the same batch stays
+    EXPECT_EQ(table.update({{"10.0.0.0/8", 11}}, {"10.0.0.0/8", "192.168.0.0/16"}), 2);
+
+    auto guard = reader.pin();
+    std::vector<SharedLpm<int>::Route> routes = {{"10.0.0.0/8", 11},
+                                                 {"2001:db8::/32", 32}};
+    EXPECT_EQ(guard->routes(), routes);
+    EXPECT_EQ(guard->version(), 2);
+}
+
+// snapshots live as long as readers hold them and no longer
+TEST(SharedLpm, Reclamation) {
+    auto value = std::make_shared<int>(1);
+    SharedLpm<std::shared_ptr<int>> table({{"10.0.0.0/8", value}});
+    auto reader = table.reader();
+
+    {
+        auto guard = reader.pin();
+        table.update({}, {"10.0.0.0/8"});
+        EXPECT_EQ(table.pending(), 1);
+
+        // the old snapshot still has the route
+        EXPECT_EQ(*guard->lookup(Address("10.1.2.3")), value);
+        EXPECT_EQ(value.use_count(), 2);
+    }
+
+    table.reclaim();
+    EXPECT_EQ(table.pending(), 0);
+    EXPECT_EQ(value.use_count(), 1);
+
+    // idle readers don't hold anything
+    table.update({{"10.0.0.0/8", value}});
+    table.update({}, {"10.0.0.0/8"});
+    EXPECT_EQ(table.pending(), 0);
+    EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(SharedLpm, Readers) {
+    SharedLpm<int> table;
+    std::vector<SharedLpm<int>::Reader> readers;
+
+    for (std::size_t i = 0; i < SharedLpm<int>::MaxReaders; ++i) {
+        readers.push_back(table.reader());
+    }
+    EXPECT_THROW(table.reader(), std::runtime_error);
+
+    readers.pop_back();
+    EXPECT_NO_THROW(table.reader());
+}
+
+// every snapshot maps both subnets to its version, so a reader never sees a
+// mix of two versions within a guard
+TEST(SharedLpm, Concurrency) {
+    constexpr int Versions = 300;
+    SharedLpm<int> table({{"10.0.0.0/8", 0}, {"2001:db8::/32", 0}});
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> mismatches{0};
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&table, &done, &mismatches] {
+            auto reader = table.reader();
+            const Raw v4(Address("10.1.2.3").addr6());
+            const Raw v6(Address("2001:db8::1").addr6());
+            int last = 0;
+
+            while (!done.load()) {
+                auto guard = reader.pin();
+                auto* first = guard->lookup(v4);
+                auto* second = guard->lookup(v6);
+
+                // versions never go back
+                if (!first || !second || *first != *second || *first < last) {
+                    ++mismatches;
+                }
+                last = first ? *first : last;
+            }
+        });
+    }
+
+    for (int version = 1; version <= Versions; ++version) {
+        table.update({{"10.0.0.0/8", version}, {"2001:db8::/32", version}});
+    }
+    done = true;
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(mismatches, 0);
+    table.reclaim();
+    EXPECT_EQ(table.pending(), 0);
+}
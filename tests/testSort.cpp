@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/sort.h>
+
+using namespace netaddr;
+
+TEST(Sort, Ordering) {
+    // clang-format off
+    const std::vector<Subnet> sorted = {
+        "::/0",
+        "::1",
+        "::ffff:0:0/95",
+        "0.0.0.0/0",
+        "1.2.3.4",
+        "10.0.0.0/8",
+        "10.0.0.0/16",
+        "10.255.0.0/16",
+        "255.255.255.255",
+        "1::",
+        "1:2:3:4::/64",
+        "ff::",
+        "2001:db8::/32",
+        "2001:db8::/33",
+        "ff00::",
+        "ffff::",
+    };
+    // clang-format on
+
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        for (std::size_t j = 0; j < sorted.size(); ++j) {
+            EXPECT_EQ(sorted[i] < sorted[j], i < j)
+                << sorted[i].str() << " and " << sorted[j].str();
+        }
+    }
+
+    EXPECT_TRUE(Raw(Address4(htonl(1))) < Raw(Address4(htonl(0x100))));
+    EXPECT_FALSE(Raw(Address4(htonl(0x100))) < Raw(Address4(htonl(1))));
+}
+
+TEST(Sort, RandomAgainstStdSort) {
+    std::mt19937 rng(12);
+
+    for (auto count : {0, 1, 100, 5000}) {
+        std::vector<Raw> raws;
+        std::vector<Subnet> subnets;
+
+        for (int i = 0; i < count; ++i) {
+            // few distinct values in the middle of addresses, so that digits repeat
+            Raw raw;
+            raw.data.bytes[0] = (std::uint8_t)rng();
+            raw.data.bytes[7] = (std::uint8_t)(rng() % 3);
+            raw.data.bytes[15] = (std::uint8_t)rng();
+            raws.push_back(raw);
+
+            char buf[INET6_ADDRSTRLEN];
+            inet_ntop(AF_INET6, &raw.data, buf, sizeof(buf));
+            subnets.emplace_back(std::string(buf) + "/" + std::to_string(rng() % 129));
+        }
+
+        auto expectedRaws = raws;
+        std::sort(expectedRaws.begin(), expectedRaws.end());
+        radixSort(raws);
+        ASSERT_TRUE(raws == expectedRaws);
+
+        auto expectedSubnets = subnets;
+        std::stable_sort(expectedSubnets.begin(), expectedSubnets.end());
+        radixSort(subnets);
+        for (std::size_t i = 0; i < subnets.size(); ++i) {
+            ASSERT_EQ(subnets[i].dump(), expectedSubnets[i].dump());
+        }
+    }
+}
+
+TEST(Sort, Threads) {
+    std::mt19937_64 rng(12);
+    std::vector<Raw> raws;
+    std::vector<Subnet> subnets;
+
+    // enough for chunks of several threads, odd so that they differ in size
+    for (int i = 0; i < 200001; ++i) {
+        Raw raw((Address4)rng());
+        raw.data.bytes[15] = (std::uint8_t)(rng() % 5);
+        raws.push_back(raw);
+
+        char buf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &raw.data.dwords[3], buf, sizeof(buf));
+        subnets.emplace_back(std::string(buf) + "/" + std::to_string(24 + rng() % 9));
+    }
+
+    auto expectedRaws = raws;
+    std::sort(expectedRaws.begin(), expectedRaws.end());
+    auto expectedSubnets = subnets;
+    std::stable_sort(expectedSubnets.begin(), expectedSubnets.end());
+
+    for (std::size_t threads : {2, 3, 0}) {
+        auto sortedRaws = raws;
+        radixSort(sortedRaws, threads);
+        ASSERT_TRUE(sortedRaws == expectedRaws) << threads;
+
+        auto sortedSubnets = subnets;
+        radixSort(sortedSubnets, threads);
+        ASSERT_TRUE(sortedSubnets == expectedSubnets) << threads;
+    }
+}
@@ -1,10 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <random>
+#include <string>
 #include <utility>
 
 #include <netaddr/subnet.h>
 
 using namespace netaddr;
+using namespace netaddr::literals;
 
 using TestPair = std::pair<const char*, const char*>;
 
@@ -26,7 +29,7 @@ TEST(Subnet, ValidConstructors) {
         "2001:db8::",
         "2001:db8::1234:5678",
         "2001:0db8:0001:0000:0000:0ab9:C0A8:0102",
-        "::1234:5678/64"
+        "::1234:5678/64",
         "::"
     };
     // clang-format on
@@ -66,11 +69,13 @@ TEST(Subnet, InvalidConstructors) {
         "2001:db8",
         "2001db8",
         "2001::db8::1",
-        ""
-        // Boost doesn't support such format
-        // neither do we
-        // the original Ada implementation, however, can handle ::ffff:a.b.c.d
-        "::ffff:192.168.1.1"
+        "",
+        // an IPv4 address only at the end and in place of two pieces
+        "::ffff:192.168.1.1:0",
+        "::ffff:192.168.1",
+        "1:2:3:4:5:6:7:192.168.1.1",
+        "1:2:3:4:5:6::192.168.1.1",
+        "::ffff:192.168.1.1/"
     };
     // clang-format on
 
@@ -82,6 +87,155 @@ TEST(Subnet, InvalidConstructors) {
     }
 }
 
+TEST(Subnet, TryParse) {
+    using TestError = std::pair<const char*, Error>;
+
+    // clang-format off
+    constexpr TestError data[] = {
+        {"192.168.1.1/24", Error::NONE},
+        {"2a02:6b8::/32", Error::NONE},
+        {"a.b.c.d", Error::BAD_IPV4},
+        {"127..0.0.1", Error::BAD_IPV4},
+        {"2001:db8:", Error::BAD_IPV6},
+        {"", Error::BAD_IPV6},
+        {"145.12.12.6/", Error::BAD_PREFIX},
+        {"145.12.12.6/-1", Error::BAD_PREFIX},
+        {"1234:4567::/12a", Error::BAD_PREFIX},
+        {"145.12.12.6/33", Error::PREFIX_OUT_OF_RANGE},
+        {"1234:4567::/129", Error::PREFIX_OUT_OF_RANGE},
+        {"1234:4567::/999999999999999999999999999999999999", Error::PREFIX_OUT_OF_RANGE},
+    };
+    // clang-format on
+
+    for (auto item : data) {
+        auto result = Subnet::tryParse(item.first);
+
+        EXPECT_EQ(result.error(), item.second) << "Unexpected error for " << item.first;
+        EXPECT_EQ(result.ok(), item.second == Error::NONE)
+            << "Unexpected result for " << item.first;
+
+        if (result) {
+            EXPECT_TRUE(*result == Subnet(item.first))
+                << "tryParse() and constructor results differ for " << item.first;
+        } else {
+            EXPECT_ANY_THROW(Subnet{item.first})
+                << "There must be exception thrown in constructor for " << item.first;
+        }
+    }
+}
+
+TEST(Subnet, Padded) {
+    // clang-format off
+    constexpr const char* data[] = {
+        "192.168.1.1/24",
+        "192.168.1.1",
+        "2a02:6b8::/32",
+        "::ffff:a01:203",
+        "a.b.c.d",
+        "2001:db8:",
+        "145.12.12.6/",
+        "145.12.12.6/033",
+        "1234:4567::/129",
+        "",
+    };
+    // clang-format on
+
+    for (auto item : data) {
+        std::string buffer = std::string(item) + std::string(16, '1');
+        PaddedStringView padded(buffer.data(), strlen(item));
+
+        auto result = Subnet::tryParse(padded);
+        auto expected = Subnet::tryParse(item);
+
+        EXPECT_EQ(result.error(), expected.error()) << item;
+        if (result) {
+            EXPECT_EQ(result->dump(), expected->dump()) << item;
+            EXPECT_TRUE(Subnet(padded) == *expected) << item;
+        } else {
+            EXPECT_ANY_THROW(Subnet{padded}) << item;
+        }
+    }
+}
+
+TEST(Subnet, Literals) {
+    // clang-format off
+    constexpr Subnet acl[] = {
+        "10.0.0.0/8"_net,
+        "192.168.1.133/24"_net,
+        "2a02:6b8::/32"_net,
+        "::ffff:0:0/96"_net,
+        "::"_net,
+    };
+    // clang-format on
+
+    static_assert(acl[0].v4() && acl[0].mapped() && acl[0].cidr() == 8);
+    static_assert(acl[2].v6() && !acl[2].mapped() && acl[2].cidr() == 32);
+    static_assert(acl[3].v6() && acl[3].mapped() && acl[3].cidr() == 128);
+    static_assert(acl[4].cidr() == 128);
+
+    EXPECT_EQ(acl[1].dump(), Subnet("192.168.1.133/24").dump());
+    EXPECT_EQ(acl[1].str(), "192.168.1.0/24");
+    EXPECT_TRUE(acl[0].contains(Subnet("10.1.2.3")));
+    EXPECT_TRUE(acl[2].contains(Subnet("2a02:6b8::1")));
+    EXPECT_FALSE(acl[2].contains(Subnet("10.1.2.3")));
+}
+
+// parseConst() must follow the constructor for any input
+TEST(Subnet, ParseConst) {
+    std::mt19937 rng(14);
+    constexpr char alphabet[] = "0123456789abcdefABCDEF.:/x";
+
+    std::vector<std::string> data = {
+        "1.1.1.1", "2.22.99.130/12", "0.0.0.0/0", "2001:db8::1234:5678", "::/0",
+        "::1234:5678/64", "::ffff:1.2.3.4", "::ffff:102:304/100", "::ffff:102:304/95",
+        "145.12.12.6/33", "1234:4567::/129", "145.12.12.6/", "22:::1", "",
+    };
+
+    // mostly almost valid subnets, a random character is changed in every other
+    for (std::size_t i = 0; i < 100000; ++i) {
+        std::string s;
+
+        if (rng() % 2) {
+            for (std::size_t j = 0; j < 4; ++j) {
+                s += (j ? "." : "") + std::to_string(rng() % 300);
+            }
+        } else {
+            auto pieces = 1 + rng() % 9;
+            auto gap = rng() % (2 * pieces);
+            for (std::size_t j = 0; j < pieces; ++j) {
+                char buf[8];
+                auto piece = (unsigned)(rng() % 0x14000);
+                snprintf(buf, sizeof(buf), rng() % 2 ? "%x" : "%X", piece);
+                s += (j ? (j == gap ? "::" : ":") : "") + std::string(buf);
+            }
+        }
+
+        if (rng() % 2) {
+            s += "/" + std::to_string(rng() % 140);
+        }
+        if (rng() % 2) {
+            s[rng() % s.size()] = alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+
+        data.push_back(s);
+    }
+
+    for (const auto& item : data) {
+        auto result = Subnet::tryParse(item);
+
+        if (!result) {
+            EXPECT_THROW(Subnet::parseConst(item), std::invalid_argument) << item;
+            continue;
+        }
+
+        auto subnet = Subnet::parseConst(item);
+        ASSERT_EQ(subnet.dump(), result->dump()) << item;
+        ASSERT_EQ(subnet.cidr(), result->cidr()) << item;
+        ASSERT_EQ(subnet.v4(), result->v4()) << item;
+        ASSERT_EQ(subnet.mapped(), result->mapped()) << item;
+    }
+}
+
 TEST(Subnet, PublicData) {
     auto ipv4 = Subnet("192.168.1.1/24");
     auto ipv6 = Subnet("fe80:133:db2::1/56");
@@ -235,6 +389,26 @@ TEST(Subnet, RFC4038) {
         << data.second;
 }
 
+// IPv6 with an IPv4 address at the end is mapped if its prefix is
+TEST(Subnet, EmbeddedIPv4) {
+    Subnet mapped("::ffff:192.0.2.1");
+    EXPECT_TRUE(mapped.v6());
+    EXPECT_TRUE(mapped.mapped());
+    EXPECT_TRUE(mapped == Subnet("::ffff:c000:201"));
+    EXPECT_TRUE(Subnet("192.0.2.0/24").contains(mapped));
+    EXPECT_EQ(mapped.str(), "::ffff:192.0.2.1");
+
+    Subnet nat64("64:ff9b::10.0.0.1");
+    EXPECT_FALSE(nat64.mapped());
+    EXPECT_TRUE(nat64 == Subnet("64:ff9b::a00:1"));
+    EXPECT_TRUE(Subnet("64:ff9b::/96").contains(nat64));
+
+    // a dot among the first characters doesn't make it IPv4
+    EXPECT_TRUE(Subnet("::1.2.3.4/120") == Subnet("::102:300/120"));
+    EXPECT_EQ(Subnet::tryParse("::1.2.3.4/129").error(), Error::PREFIX_OUT_OF_RANGE);
+    EXPECT_EQ(Subnet::tryParse("::1.2.3").error(), Error::BAD_IPV6);
+}
+
 TEST(Subnet, ChildNetworks) {
     // clang-format off
     constexpr TestPair data[] = {
@@ -450,3 +624,29 @@ TEST(Subnet, Operators) {
     auto expected = "00000000000000000000FFFFC0A80101{FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF}";
     EXPECT_TRUE(dump == expected);
 }
+
+TEST(Subnet, RawAndLength) {
+    for (auto text : {"10.1.0.0/16", "0.0.0.0/0", "1.2.3.4", "2001:db8::/32", "::/0",
+                      "::ffff:1.2.3.4", "::ffff:0:0/95", "fe80::1"}) {
+        Subnet subnet(text);
+        auto proto = subnet.v4() ? Subnet::Protocol::IPV4 : Subnet::Protocol::IPV6;
+        Subnet copy(subnet.raw(), subnet.length(), proto);
+
+        EXPECT_EQ(copy.dump(), subnet.dump()) << text;
+        EXPECT_EQ(copy.mapped(), subnet.mapped()) << text;
+        EXPECT_EQ(copy.v4(), subnet.v4()) << text;
+        EXPECT_EQ(copy.contains(subnet), true) << text;
+
+        Raw mask;
+        _mm_storeu_si128((__m128i*)&mask, Subnet::bitmask(subnet.length()));
+        EXPECT_EQ(Raw(subnet.mask6()), mask) << text;
+    }
+
+    Subnet v4("10.1.0.0/16");
+    EXPECT_EQ(v4.length(), v4.cidr() + Subnet::IPv4PrefixOffset);
+    EXPECT_EQ(v4.raw(), Raw(v4.addr4().s_addr));
+
+    // addresses are masked
+    Subnet masked(Raw(Subnet("2001:db8::1").addr6()), 32, Subnet::Protocol::IPV6);
+    EXPECT_EQ(masked, Subnet("2001:db8::/32"));
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include <netaddr/hash.h>
+#include <netaddr/subnet4.h>
+
+using namespace netaddr;
+
+// clang-format off
+static const std::vector<std::string_view> Subnets = {
+    "0.0.0.0/0",
+    "10.0.0.0/8",
+    "10.1.2.0/24",
+    "10.1.2.3",
+    "10.1.2.3/31",
+    "128.0.0.0/1",
+    "192.168.0.1/16",
+    "255.255.255.255",
+};
+// clang-format on
+
+TEST(Subnet4, Size) {
+    EXPECT_EQ(sizeof(Subnet4), 8);
+}
+
+TEST(Subnet4, Parse) {
+    for (auto text : Subnets) {
+        Subnet subnet(text);
+        Subnet4 subnet4(text);
+
+        EXPECT_EQ(subnet4.str(), subnet.str()) << text;
+        EXPECT_EQ(subnet4.cidr(), subnet.cidr()) << text;
+        EXPECT_EQ(subnet4.addr4().s_addr, subnet.addr4().s_addr) << text;
+        EXPECT_EQ(subnet4.mask4().s_addr, subnet.mask4().s_addr) << text;
+    }
+
+    EXPECT_EQ(Subnet4("10.1.2.3/008"), Subnet4("10.0.0.0/8"));
+
+    EXPECT_EQ(Subnet4::tryParse("2001:db8::/32").error(), Error::BAD_IPV4);
+    EXPECT_EQ(Subnet4::tryParse("::ffff:a01:203").error(), Error::BAD_IPV4);
+    EXPECT_EQ(Subnet4::tryParse("10.0.0.0/33").error(), Error::PREFIX_OUT_OF_RANGE);
+    EXPECT_EQ(Subnet4::tryParse("10.0.0.0/").error(), Error::BAD_PREFIX);
+    EXPECT_EQ(Subnet4::tryParse("10.0.0.256").error(), Error::BAD_IPV4);
+    EXPECT_ANY_THROW(Subnet4("10.0.0"));
+}
+
+TEST(Subnet4, Conversion) {
+    for (auto text : Subnets) {
+        Subnet subnet(text);
+        Subnet4 subnet4(subnet);
+
+        EXPECT_EQ(subnet4, Subnet4(text));
+        EXPECT_EQ(subnet4.subnet().dump(), subnet.dump()) << text;
+        EXPECT_TRUE(subnet4.subnet().v4());
+        EXPECT_TRUE(subnet4.subnet().mapped());
+    }
+
+    EXPECT_ANY_THROW(Subnet4(Subnet("2001:db8::/32")));
+    EXPECT_ANY_THROW(Subnet4(Subnet("::ffff:a01:203")));
+    EXPECT_ANY_THROW(Subnet4{Subnet()});
+
+    EXPECT_EQ(Subnet4(Subnet4("10.1.2.3").addr4().s_addr, 16), Subnet4("10.1.0.0/16"));
+}
+
+TEST(Subnet4, Contains) {
+    for (auto parentText : Subnets) {
+        Subnet parent(parentText);
+        Subnet4 parent4(parentText);
+
+        for (auto childText : Subnets) {
+            Subnet child(childText);
+            Subnet4 child4(childText);
+
+            EXPECT_EQ(parent4.contains(child4), parent.contains(child))
+                << parentText << " and " << childText;
+            EXPECT_EQ(child4.belongs(parent4), child.belongs(parent))
+                << childText << " and " << parentText;
+        }
+    }
+
+    Subnet4 subnet("10.1.0.0/16");
+    EXPECT_TRUE(subnet.contains(Subnet4("10.1.255.255").addr4().s_addr));
+    EXPECT_FALSE(subnet.contains(Subnet4("10.2.0.0").addr4().s_addr));
+    EXPECT_TRUE(Subnet4("0.0.0.0/0").contains(Subnet4("1.2.3.4").addr4().s_addr));
+}
+
+TEST(Subnet4, Order) {
+    std::vector<Subnet> subnets;
+    std::vector<Subnet4> subnets4;
+    for (auto text : Subnets) {
+        subnets.emplace_back(text);
+        subnets4.emplace_back(text);
+    }
+
+    std::sort(subnets.begin(), subnets.end());
+    std::sort(subnets4.begin(), subnets4.end());
+    for (std::size_t i = 0; i < subnets.size(); ++i) {
+        EXPECT_EQ(subnets4[i].str(), subnets[i].str());
+    }
+
+    std::unordered_set<Subnet4> set(subnets4.begin(), subnets4.end());
+    EXPECT_EQ(set.size(), subnets4.size());
+    EXPECT_EQ(set.count("10.1.2.0/24"), 1);
+    EXPECT_EQ(set.count("10.1.2.0/25"), 0);
+}
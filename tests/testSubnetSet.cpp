@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <netaddr/address.h>
+#include <netaddr/subnetset.h>
+
+using namespace netaddr;
+
+TEST(SubnetSet, Find) {
+    SubnetSet set({
+        "10.0.0.0/8",
+        "2a02:6b8::/32",
+        "10.1.2.0/24",
+        "::ffff:a01:0/112",
+        "0.0.0.0/0",
+    });
+
+    EXPECT_EQ(set.size(), 5);
+    EXPECT_EQ(set.find(Address("10.1.2.3")), 0);
+    EXPECT_EQ(set.find(Address("11.1.2.3")), 4);
+    EXPECT_EQ(set.find(Address("2a02:6b8::1")), 1);
+    EXPECT_EQ(set.find(Address("2a02:6b9::1")), SubnetSet::npos);
+    EXPECT_EQ(set.find(Subnet("10.0.0.0/7")), 4) << "Wider subnets aren't contained";
+    EXPECT_TRUE(set.contains(Subnet("10.1.2.0/25")));
+    EXPECT_FALSE(SubnetSet().contains(Address("10.1.2.3")));
+
+    std::vector<std::size_t> all;
+    EXPECT_EQ(set.findAll(Address("10.1.2.3"), all), 3);
+    EXPECT_EQ(all, (std::vector<std::size_t>{0, 2, 4}));
+}
+
+TEST(SubnetSet, RandomAgainstContains) {
+    std::mt19937 rng(7);
+    std::vector<Subnet> subnets;
+
+    // narrow the address space, so that subnets overlap a lot
+    auto random4 = [&rng]() {
+        return "10." + std::to_string(rng() % 2) + "." + std::to_string(rng() % 4) + "." +
+               std::to_string(rng() % 256);
+    };
+    auto random6 = [&rng]() {
+        char buf[INET6_ADDRSTRLEN];
+        struct in6_addr addr = {};
+
+        addr.s6_addr[0] = 0x2a;
+        addr.s6_addr[1] = rng() % 2;
+        addr.s6_addr[2] = rng() % 4;
+        addr.s6_addr[15] = rng();
+
+        inet_ntop(AF_INET6, &addr, buf, sizeof(buf));
+        return std::string(buf);
+    };
+
+    for (std::size_t i = 0; i < 301; ++i) {
+        if (rng() % 2) {
+            subnets.emplace_back(random4() + "/" + std::to_string(rng() % 33));
+        } else {
+            subnets.emplace_back(random6() + "/" + std::to_string(rng() % 129));
+        }
+    }
+
+    SubnetSet set(subnets);
+    std::vector<Address> addresses;
+    for (std::size_t i = 0; i < 2000; ++i) {
+        addresses.emplace_back(rng() % 2 ? random4() : random6());
+    }
+
+    // every kernel the CPU has
+    auto saved = Cpu::level();
+    for (auto level : {Cpu::Level::SCALAR, Cpu::Level::SSE42, Cpu::Level::AVX2,
+                       Cpu::Level::AVX512}) {
+        if (Cpu::setLevel(level) != level) {
+            continue;
+        }
+
+        for (const auto& address : addresses) {
+            std::vector<std::size_t> expected;
+
+            for (std::size_t j = 0; j < subnets.size(); ++j) {
+                if (subnets[j].contains(address)) {
+                    expected.push_back(j);
+                }
+            }
+
+            std::vector<std::size_t> all;
+            ASSERT_EQ(set.findAll(address, all), expected.size()) << Cpu::describe(level);
+            ASSERT_EQ(all, expected) << Cpu::describe(level);
+            ASSERT_EQ(set.find(address), expected.empty() ? SubnetSet::npos : expected[0])
+                << Cpu::describe(level);
+        }
+    }
+    Cpu::setLevel(saved);
+}